@@ -0,0 +1,67 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+
+struct ArenaBlock_t
+{
+	ArenaBlock_t* Next;
+	size_t Used;
+	size_t Capacity;
+	alignas(max_align_t) unsigned char Data[];
+};
+
+void init_arena(Arena_t* Arena, size_t BlockSize)
+{
+	Arena->Head = NULL;
+	Arena->BlockSize = BlockSize;
+	Arena->Used = 0;
+	Arena->Reserved = 0;
+}
+
+void* arena_alloc(Arena_t* Arena, size_t Size)
+{
+	size_t Padded = (Size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+	ArenaBlock_t* Block = Arena->Head;
+
+	if (!Block || Block->Capacity - Block->Used < Padded)
+	{
+		size_t Capacity = Padded > Arena->BlockSize ? Padded : Arena->BlockSize; // Oversized ones get a block to themselves
+
+		Block = malloc(sizeof(ArenaBlock_t) + Capacity);
+
+		if (!Block)
+			return NULL;
+
+		Block->Next = Arena->Head;
+		Block->Used = 0;
+		Block->Capacity = Capacity;
+
+		Arena->Head = Block;
+		Arena->Reserved += sizeof(ArenaBlock_t) + Capacity;
+	}
+
+	void* Data = Block->Data + Block->Used;
+
+	Block->Used += Padded;
+	Arena->Used += Padded;
+
+	memset(Data, 0, Size);
+
+	return Data;
+}
+
+void free_arena(Arena_t* Arena)
+{
+	ArenaBlock_t* Block = Arena->Head;
+
+	while (Block)
+	{
+		ArenaBlock_t* Next = Block->Next;
+		free(Block);
+		Block = Next;
+	}
+
+	init_arena(Arena, Arena->BlockSize);
+}
@@ -0,0 +1,23 @@
+#ifndef ogt_arena
+#define ogt_arena
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE 4096
+
+typedef struct ArenaBlock_t ArenaBlock_t;
+
+// Bump allocator for data that lives as long as the arena, everything is freed at once
+typedef struct
+{
+	ArenaBlock_t* Head; // Newest block, allocations come from here
+	size_t BlockSize;
+	size_t Used; // Bytes handed out, alignment padding included
+	size_t Reserved; // Bytes allocated from the heap
+} Arena_t;
+
+void init_arena(Arena_t* Arena, size_t BlockSize);
+void* arena_alloc(Arena_t* Arena, size_t Size); // Zeroed and aligned for any type, NULL when out of memory
+void free_arena(Arena_t* Arena);
+
+#endif
@@ -0,0 +1,598 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "models.h"
+#include "objparse.h"
+#include "jobs.h"
+#include "util.h"
+#include "normals.h"
+#include "globals.h"
+
+#define BENCH_UPLOAD_ITERATIONS 100
+#define BENCH_OBJ_TRIANGLES 1000000
+#define BENCH_OBJ_PATH "bench_parse.obj"
+#define BENCH_NORMALS_SIDE 708 // Grid vertices per side, about a million triangles
+#define BENCH_TEXTURE_ITERATIONS 5
+#define BENCH_ENTITY_COUNT 100000
+#define BENCH_ENTITY_FRAMES 100
+
+typedef bool (*BenchmarkFn)(int ArgCount, char** Args);
+
+typedef struct
+{
+	const char* Name;
+	BenchmarkFn Run;
+} Benchmark_t;
+
+static const char* DefaultModels[] =
+{
+	"../src/models/bluemodel.obj",
+	"../src/models/monkey.obj",
+	"../src/models/playne.obj",
+	"../src/models/spongekey.obj"
+};
+
+static const char* DefaultTextures[] =
+{
+	"../src/textures/hahaball.png",
+	"../src/textures/spongebob.jpg",
+	"../src/textures/wall.jpg"
+};
+
+static double time_upload(const void* Data, size_t Size)
+{
+	unsigned int Buffer;
+	glGenBuffers(1, &Buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, Buffer);
+	glFinish();
+
+	double Start = glfwGetTime();
+
+	for (int i = 0; i < BENCH_UPLOAD_ITERATIONS; ++i)
+	{
+		glBufferData(GL_ARRAY_BUFFER, Size, Data, GL_STATIC_DRAW);
+		glFinish();
+	}
+
+	double Elapsed = glfwGetTime() - Start;
+
+	glDeleteBuffers(1, &Buffer);
+
+	return Elapsed / BENCH_UPLOAD_ITERATIONS;
+}
+
+static bool bench_vertex_layout(int ArgCount, char** Args)
+{
+	if (ArgCount <= 0)
+	{
+		ArgCount = sizeof(DefaultModels) / sizeof(DefaultModels[0]);
+		Args = (char**)DefaultModels;
+	}
+
+	for (int i = 0; i < ArgCount; ++i)
+	{
+		ModelInfo_t ModelInfo = { 0 };
+		ModelInfo.ModelPath = Args[i];
+
+		load_obj(&ModelInfo);
+
+		if (ModelInfo.VertexCount <= 0)
+		{
+			printf("Failed to load model for '%s'\n", Args[i]);
+
+			return 0;
+		}
+
+		for (VertexLayout_t Layout = VERTEX_LAYOUT_FULL; Layout <= VERTEX_LAYOUT_COMPACT; ++Layout)
+		{
+			double Start = glfwGetTime();
+			void* VertexData = pack_vertices(&ModelInfo, Layout);
+			double PackTime = glfwGetTime() - Start;
+
+			if (!VertexData)
+			{
+				printf("Failed to pack vertices for '%s'\n", Args[i]);
+				free_model_data(&ModelInfo);
+
+				return 0;
+			}
+
+			size_t Size = ModelInfo.VertexCount * get_vertex_size(Layout);
+			double UploadTime = time_upload(VertexData, Size);
+
+			printf(
+				"%-32s %-8s %2zu bytes/vertex %9zu bytes pack %8.3f ms upload %8.3f ms\n",
+
+				Args[i],
+				Layout == VERTEX_LAYOUT_COMPACT ? "compact" : "full",
+				get_vertex_size(Layout),
+				Size,
+				PackTime * 1000.0,
+				UploadTime * 1000.0
+			);
+
+			if (VertexData != ModelInfo.Vertices)
+				free(VertexData);
+		}
+
+		free_model_data(&ModelInfo);
+	}
+
+	return 1;
+}
+
+static bool write_grid_obj(const char* Path, size_t TriangleCount)
+{
+	FILE* File = fopen(Path, "w");
+
+	if (!File)
+		return 0;
+
+	size_t Side = 1;
+
+	while (Side * Side * 2 < TriangleCount)
+		Side++;
+
+	for (size_t y = 0; y <= Side; ++y)
+		for (size_t x = 0; x <= Side; ++x)
+			fprintf(File, "v %f %f %f\nvt %f %f\n", (float)x / Side, (float)y / Side, 0.f, (float)x / Side, (float)y / Side);
+
+	fprintf(File, "vn 0.000000 0.000000 1.000000\n");
+
+	for (size_t y = 0; y < Side; ++y)
+	{
+		for (size_t x = 0; x < Side; ++x)
+		{
+			size_t A = (y * (Side + 1)) + x + 1;
+			size_t B = A + 1;
+			size_t C = A + Side + 1;
+			size_t D = C + 1;
+
+			fprintf(File, "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n", A, A, B, B, D, D, C, C);
+		}
+	}
+
+	return fclose(File) == 0;
+}
+
+static bool compare_attributes(const tinyobj_attrib_t* A, const tinyobj_attrib_t* B)
+{
+	return A->num_vertices == B->num_vertices
+		&& A->num_normals == B->num_normals
+		&& A->num_texcoords == B->num_texcoords
+		&& A->num_faces == B->num_faces
+		&& A->num_face_num_verts == B->num_face_num_verts
+		&& memcmp(A->vertices, B->vertices, A->num_vertices * 3 * sizeof(float)) == 0
+		&& memcmp(A->normals, B->normals, A->num_normals * 3 * sizeof(float)) == 0
+		&& memcmp(A->texcoords, B->texcoords, A->num_texcoords * 2 * sizeof(float)) == 0
+		&& memcmp(A->faces, B->faces, A->num_faces * sizeof(tinyobj_vertex_index_t)) == 0
+		&& memcmp(A->face_num_verts, B->face_num_verts, A->num_face_num_verts * sizeof(int)) == 0
+		&& memcmp(A->material_ids, B->material_ids, A->num_face_num_verts * sizeof(int)) == 0;
+}
+
+static bool bench_obj_parse(int ArgCount, char** Args)
+{
+	const char* Path = BENCH_OBJ_PATH;
+	bool Generated = 0;
+
+	if (ArgCount > 0)
+		Path = Args[0];
+	else
+	{
+		if (!write_grid_obj(Path, BENCH_OBJ_TRIANGLES))
+		{
+			printf("Failed to write '%s'\n", Path);
+
+			return 0;
+		}
+
+		Generated = 1;
+	}
+
+	void* Data;
+	size_t Size;
+
+	if (!map_file(Path, &Data, &Size))
+	{
+		printf("Failed to map '%s'\n", Path);
+
+		if (Generated)
+			remove(Path);
+
+		return 0;
+	}
+
+	tinyobj_attrib_t Serial, Parallel;
+	tinyobj_material_t* SerialMaterials;
+	tinyobj_material_t* ParallelMaterials;
+	size_t SerialMaterialCount, ParallelMaterialCount;
+
+	double Start = glfwGetTime();
+	int SerialResult = parse_obj_serial(&Serial, &SerialMaterials, &SerialMaterialCount, Path);
+	double SerialTime = glfwGetTime() - Start;
+
+	Start = glfwGetTime();
+	int ParallelResult = parse_obj_parallel(&Parallel, &ParallelMaterials, &ParallelMaterialCount, Path, (const char*)Data, Size);
+	double ParallelTime = glfwGetTime() - Start;
+
+	unmap_file(Data, Size);
+
+	if (Generated)
+		remove(Path);
+
+	bool Passed = SerialResult == TINYOBJ_SUCCESS && ParallelResult == TINYOBJ_SUCCESS;
+
+	if (Passed)
+	{
+		bool Matches = compare_attributes(&Serial, &Parallel) && SerialMaterialCount == ParallelMaterialCount;
+
+		printf(
+			"%-32s %10zu bytes %9u faces %2u workers serial %8.3f ms parallel %8.3f ms (%.2fx) %s\n",
+
+			Path,
+			Size,
+			Serial.num_face_num_verts,
+			ogt_get_worker_count(),
+			SerialTime * 1000.0,
+			ParallelTime * 1000.0,
+			SerialTime / ParallelTime,
+			Matches ? "match" : "MISMATCH"
+		);
+
+		Passed = Matches;
+	}
+	else
+		printf("Failed to parse '%s'\n", Path);
+
+	if (SerialResult == TINYOBJ_SUCCESS)
+	{
+		tinyobj_attrib_free(&Serial);
+		tinyobj_materials_free(SerialMaterials, SerialMaterialCount);
+	}
+
+	if (ParallelResult == TINYOBJ_SUCCESS)
+	{
+		tinyobj_attrib_free(&Parallel);
+		tinyobj_materials_free(ParallelMaterials, ParallelMaterialCount);
+	}
+
+	return Passed;
+}
+
+// Wavy grid so the normals aren't all the same, texcoords follow the grid
+static bool bench_normals(int, char**)
+{
+	size_t Side = BENCH_NORMALS_SIDE;
+	size_t VertexCount = Side * Side;
+	size_t IndexCount = (Side - 1) * (Side - 1) * 6;
+
+	float* Vertices = calloc(VertexCount, OBJ_CHUNK_SIZE);
+	unsigned int* Indices = malloc(IndexCount * sizeof(unsigned int));
+
+	if (!Vertices || !Indices)
+	{
+		printf("Failed to allocate for normals benchmark\n");
+
+		free(Vertices);
+		free(Indices);
+
+		return 0;
+	}
+
+	for (size_t y = 0; y < Side; ++y)
+	{
+		for (size_t x = 0; x < Side; ++x)
+		{
+			float* Vertex = &Vertices[((y * Side) + x) * OBJ_CHUNK_FLOATS];
+			float U = (float)x / (Side - 1);
+			float V = (float)y / (Side - 1);
+
+			Vertex[0] = U;
+			Vertex[1] = sinf(U * 20.f) * cosf(V * 20.f) * .05f;
+			Vertex[2] = V;
+
+			Vertex[OBJ_TEXCOORD_OFFSET + 0] = U;
+			Vertex[OBJ_TEXCOORD_OFFSET + 1] = V;
+		}
+	}
+
+	size_t Index = 0;
+
+	for (size_t y = 0; y + 1 < Side; ++y)
+	{
+		for (size_t x = 0; x + 1 < Side; ++x)
+		{
+			unsigned int A = (unsigned int)((y * Side) + x);
+			unsigned int B = A + 1;
+			unsigned int C = A + (unsigned int)Side;
+			unsigned int D = C + 1;
+
+			Indices[Index++] = A;
+			Indices[Index++] = C;
+			Indices[Index++] = B;
+			Indices[Index++] = B;
+			Indices[Index++] = C;
+			Indices[Index++] = D;
+		}
+	}
+
+	double Start = glfwGetTime();
+	bool Passed = generate_normals(Vertices, OBJ_CHUNK_FLOATS, VertexCount, Indices, IndexCount, OBJ_NORMAL_OFFSET, NULL, 0);
+	double NormalTime = glfwGetTime() - Start;
+
+	Start = glfwGetTime();
+	Passed = Passed && generate_tangents(Vertices, OBJ_CHUNK_FLOATS, VertexCount, Indices, IndexCount, OBJ_NORMAL_OFFSET, OBJ_TEXCOORD_OFFSET, OBJ_TANGENT_OFFSET);
+	double TangentTime = glfwGetTime() - Start;
+
+	if (Passed)
+		printf("%9zu vertices %9zu triangles normals %8.3f ms tangents %8.3f ms\n", VertexCount, IndexCount / 3, NormalTime * 1000.0, TangentTime * 1000.0);
+	else
+		printf("Failed to generate normals\n");
+
+	free(Vertices);
+	free(Indices);
+
+	return Passed;
+}
+
+typedef struct
+{
+	const char* Path;
+	TextureData_t* Texture;
+} DecodeJob_t;
+
+static void decode_texture_job(void* Data)
+{
+	DecodeJob_t* Job = (DecodeJob_t*)Data;
+
+	load_texture_data(Job->Path, Job->Texture);
+}
+
+static void free_textures(TextureData_t* Textures, int Count)
+{
+	for (int i = 0; i < Count; ++i)
+		free_texture_data(&Textures[i]);
+}
+
+// Straight stb_image decodes, bakes would skip the part being measured
+static bool bench_texture_decode(int ArgCount, char** Args)
+{
+	const char** Paths = (const char**)Args;
+	int Count = ArgCount;
+
+	if (Count <= 0)
+	{
+		Paths = DefaultTextures;
+		Count = sizeof(DefaultTextures) / sizeof(DefaultTextures[0]);
+	}
+
+	TextureData_t* Serial = calloc(Count, sizeof(TextureData_t));
+	TextureData_t* Parallel = calloc(Count, sizeof(TextureData_t));
+	DecodeJob_t* Jobs = calloc(Count, sizeof(DecodeJob_t));
+
+	if (!Serial || !Parallel || !Jobs)
+	{
+		printf("Failed to allocate for texture decode benchmark\n");
+
+		free(Serial);
+		free(Parallel);
+		free(Jobs);
+
+		return 0;
+	}
+
+	for (int i = 0; i < Count; ++i)
+	{
+		Jobs[i].Path = Paths[i];
+		Jobs[i].Texture = &Parallel[i];
+	}
+
+	bool Passed = 1;
+	double SerialTime = 0.0, ParallelTime = 0.0;
+
+	for (int Iteration = 0; Passed && Iteration < BENCH_TEXTURE_ITERATIONS; ++Iteration)
+	{
+		double Start = glfwGetTime();
+
+		for (int i = 0; i < Count; ++i)
+			Passed = load_texture_data(Paths[i], &Serial[i]) && Passed;
+
+		SerialTime += glfwGetTime() - Start;
+
+		JobCounter_t Counter = { 0 };
+		Start = glfwGetTime();
+
+		for (int i = 0; i < Count; ++i)
+			ogt_submit_job(decode_texture_job, &Jobs[i], &Counter);
+
+		ogt_wait_for_jobs(&Counter);
+		ParallelTime += glfwGetTime() - Start;
+
+		for (int i = 0; i < Count; ++i)
+		{
+			Passed = Passed && Parallel[i].Pixels
+				&& Serial[i].Width == Parallel[i].Width
+				&& Serial[i].Height == Parallel[i].Height
+				&& Serial[i].Channels == Parallel[i].Channels
+				&& memcmp(Serial[i].Pixels, Parallel[i].Pixels, (size_t)Serial[i].Width * Serial[i].Height * Serial[i].Channels) == 0;
+		}
+
+		free_textures(Serial, Count);
+		free_textures(Parallel, Count);
+	}
+
+	if (Passed)
+	{
+		printf(
+			"%3d textures %2u workers serial %8.3f ms parallel %8.3f ms (%.2fx)\n",
+
+			Count,
+			ogt_get_worker_count(),
+			SerialTime * 1000.0 / BENCH_TEXTURE_ITERATIONS,
+			ParallelTime * 1000.0 / BENCH_TEXTURE_ITERATIONS,
+			SerialTime / ParallelTime
+		);
+	}
+	else
+		printf("Failed to decode textures\n");
+
+	free(Serial);
+	free(Parallel);
+	free(Jobs);
+
+	return Passed;
+}
+
+static void bench_entity_think(Entity_t* self, float DeltaTime)
+{
+	float* Angles = ogt_get_entity_angles(self);
+
+	Angles[1] += DeltaTime * 90.f;
+}
+
+static void bench_ecs_spin(EcsChunk_t* Chunk, void* Data)
+{
+	EcsTransform_t* Transforms = ogt_ecs_chunk_components(Chunk, ECS_TRANSFORM);
+	float DeltaTime = *(float*)Data;
+
+	for (unsigned int i = 0; i < Chunk->Count; ++i)
+		Transforms[i].Angles[1] += DeltaTime * 90.f;
+}
+
+// Same spin and transform build per frame through entity callbacks, serial and parallel, and through an ECS query
+static bool bench_entities(int ArgCount, char** Args)
+{
+	size_t Count = ArgCount > 0 ? strtoul(Args[0], NULL, 10) : BENCH_ENTITY_COUNT;
+	float DeltaTime = 1.f / 60.f;
+
+	EntityCallbacks_t* Callbacks = ogt_init_entity_callbacks();
+	EntityClass_t* Class = Callbacks ? ogt_register_entity_class("bench", Callbacks) : NULL;
+	EntityHandle_t* Handles = calloc(Count, sizeof(EntityHandle_t)); // Zeroed so a failed run only deletes what it made
+	EcsEntity_t* EcsEntities = calloc(Count, sizeof(EcsEntity_t));
+
+	if (!Class || !Handles || !EcsEntities)
+	{
+		printf("Failed to set up entity benchmark\n");
+
+		free(Handles);
+		free(EcsEntities);
+
+		return 0;
+	}
+
+	Callbacks->Think = bench_entity_think;
+
+	bool Passed = 1;
+	double Start = glfwGetTime();
+
+	for (size_t i = 0; i < Count && Passed; ++i)
+		Passed = (Handles[i] = ogt_create_entity_handle(Class)) != ENTITY_NULL_HANDLE;
+
+	double EntityCreate = glfwGetTime() - Start;
+
+	Start = glfwGetTime();
+
+	for (size_t i = 0; i < Count && Passed; ++i)
+		Passed = (EcsEntities[i] = ogt_ecs_create(ECS_MASK(ECS_TRANSFORM) | ECS_MASK(ECS_COLOR))) != ECS_NULL_ENTITY;
+
+	double EcsCreate = glfwGetTime() - Start;
+
+	Start = glfwGetTime();
+
+	for (int i = 0; i < BENCH_ENTITY_FRAMES && Passed; ++i)
+	{
+		ogt_think_entities(DeltaTime);
+		ogt_update_entity_transforms();
+	}
+
+	double EntityFrame = (glfwGetTime() - Start) / BENCH_ENTITY_FRAMES;
+
+	// Same again with the spin spread over the job system
+	Class->ParallelThink = 1;
+	Start = glfwGetTime();
+
+	for (int i = 0; i < BENCH_ENTITY_FRAMES && Passed; ++i)
+	{
+		ogt_think_entities(DeltaTime);
+		ogt_update_entity_transforms();
+	}
+
+	double ParallelFrame = (glfwGetTime() - Start) / BENCH_ENTITY_FRAMES;
+
+	Start = glfwGetTime();
+
+	for (int i = 0; i < BENCH_ENTITY_FRAMES && Passed; ++i)
+	{
+		ogt_ecs_query(ECS_MASK(ECS_TRANSFORM), bench_ecs_spin, &DeltaTime);
+		ogt_ecs_render(); // Builds transforms, nothing here is renderable so nothing draws
+	}
+
+	double EcsFrame = (glfwGetTime() - Start) / BENCH_ENTITY_FRAMES;
+
+	Start = glfwGetTime();
+
+	for (size_t i = 0; i < Count; ++i)
+		ogt_delete_entity_handle(Handles[i]);
+
+	double EntityDelete = glfwGetTime() - Start;
+
+	Start = glfwGetTime();
+
+	for (size_t i = 0; i < Count; ++i)
+		ogt_ecs_destroy(EcsEntities[i]);
+
+	double EcsDelete = glfwGetTime() - Start;
+
+	if (Passed)
+	{
+		printf("%zu entities, times in ms\n", Count);
+		printf("callbacks create %8.3f frame %8.3f delete %8.3f\n", EntityCreate * 1000.0, EntityFrame * 1000.0, EntityDelete * 1000.0);
+		printf("parallel thinks           frame %8.3f on %u workers\n", ParallelFrame * 1000.0, ogt_get_worker_count());
+		printf("ecs       create %8.3f frame %8.3f delete %8.3f\n", EcsCreate * 1000.0, EcsFrame * 1000.0, EcsDelete * 1000.0);
+	}
+	else
+		printf("Failed to create entities\n");
+
+	free(Handles);
+	free(EcsEntities);
+
+	return Passed;
+}
+
+static const Benchmark_t Benchmarks[] =
+{
+	{ "vertex-layout", bench_vertex_layout },
+	{ "obj-parse", bench_obj_parse },
+	{ "normals", bench_normals },
+	{ "texture-decode", bench_texture_decode },
+	{ "entities", bench_entities }
+};
+
+bool ogt_run_benchmarks(int ArgCount, char** Args)
+{
+	size_t BenchmarkCount = sizeof(Benchmarks) / sizeof(Benchmarks[0]);
+
+	if (ArgCount <= 0)
+	{
+		printf("Usage: --bench <name> [args...]\nBenchmarks:\n");
+
+		for (size_t i = 0; i < BenchmarkCount; ++i)
+			printf("\t%s\n", Benchmarks[i].Name);
+
+		return 0;
+	}
+
+	for (size_t i = 0; i < BenchmarkCount; ++i)
+		if (strcmp(Args[0], Benchmarks[i].Name) == 0)
+			return Benchmarks[i].Run(ArgCount - 1, Args + 1);
+
+	printf("Unknown benchmark '%s'\n", Args[0]);
+
+	return 0;
+}
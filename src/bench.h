@@ -0,0 +1,6 @@
+#ifndef ogt_bench
+#define ogt_bench
+
+bool ogt_run_benchmarks(int ArgCount, char** Args);
+
+#endif
@@ -0,0 +1,565 @@
+#include "ecs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cglm/cglm.h>
+
+#include "globals.h"
+#include "util.h"
+
+static const size_t ComponentSizes[ECS_COMPONENT_COUNT] =
+{
+	sizeof(EcsTransform_t),
+	sizeof(EcsBody_t),
+	sizeof(EcsRenderable_t),
+	sizeof(vec4)
+};
+
+static inline size_t align_chunk_offset(size_t Offset)
+{
+	return (Offset + ECS_CHUNK_ALIGNMENT - 1) & ~(size_t)(ECS_CHUNK_ALIGNMENT - 1);
+}
+
+static inline uint32_t get_ecs_index(EcsEntity_t Entity)
+{
+	return Entity & (ECS_MAX_ENTITIES - 1);
+}
+
+static inline EcsEntity_t next_ecs_entity(EcsEntity_t Entity)
+{
+	uint32_t Generation = (Entity >> ECS_INDEX_BITS) + 1;
+
+	if (Generation >= (1u << ECS_GENERATION_BITS))
+		Generation = 1;
+
+	return (Generation << ECS_INDEX_BITS) | get_ecs_index(Entity);
+}
+
+static inline unsigned char* get_row(EcsChunk_t* Chunk, EcsComponent_t Component, uint32_t Row)
+{
+	return (unsigned char*)Chunk + Chunk->Archetype->Offsets[Component] + Row * ComponentSizes[Component];
+}
+
+void ogt_init_ecs()
+{
+	GlobalVars->EcsWorld = (EcsWorld_t*)calloc(1, sizeof(EcsWorld_t));
+
+	if (!GlobalVars->EcsWorld)
+	{
+		printf("Failed to allocate for ECS world!\n");
+		return;
+	}
+
+	GlobalVars->EcsWorld->FreeHead = ECS_NO_INDEX;
+	GlobalVars->EcsWorld->FreeTail = ECS_NO_INDEX;
+}
+
+// Arrays are laid out back to back, shrinking the row count until the last one fits in the chunk
+static bool layout_archetype(EcsArchetype_t* Archetype)
+{
+	size_t RowSize = sizeof(EcsEntity_t);
+
+	for (int c = 0; c < ECS_COMPONENT_COUNT; ++c)
+		if (Archetype->Mask & ECS_MASK(c))
+			RowSize += ComponentSizes[c];
+
+	for (size_t Capacity = ECS_CHUNK_SIZE / RowSize; Capacity > 0; --Capacity)
+	{
+		size_t Offset = align_chunk_offset(sizeof(EcsChunk_t));
+
+		for (int c = 0; c < ECS_COMPONENT_COUNT; ++c)
+		{
+			Archetype->Offsets[c] = 0;
+
+			if (Archetype->Mask & ECS_MASK(c))
+			{
+				Archetype->Offsets[c] = Offset;
+				Offset = align_chunk_offset(Offset + Capacity * ComponentSizes[c]);
+			}
+		}
+
+		Archetype->EntityOffset = Offset;
+		Offset += Capacity * sizeof(EcsEntity_t);
+
+		if (Offset <= ECS_CHUNK_SIZE)
+		{
+			Archetype->ChunkCapacity = (unsigned int)Capacity;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static EcsArchetype_t* find_archetype(EcsMask_t Mask)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+
+	for (unsigned int i = 0; i < World->ArchetypeCount; ++i)
+		if (World->Archetypes[i].Mask == Mask)
+			return &World->Archetypes[i];
+
+	if (World->ArchetypeCount >= ECS_MAX_ARCHETYPES)
+	{
+		printf("Too many ECS archetypes! %u\n", World->ArchetypeCount);
+		return NULL;
+	}
+
+	EcsArchetype_t* Archetype = &World->Archetypes[World->ArchetypeCount];
+	memset(Archetype, 0, sizeof(EcsArchetype_t));
+	Archetype->Mask = Mask;
+
+	if (!layout_archetype(Archetype))
+	{
+		printf("ECS archetype %x doesn't fit in a chunk\n", Mask);
+		return NULL;
+	}
+
+	World->ArchetypeCount++;
+
+	return Archetype;
+}
+
+// Appends a row to the archetype's last chunk, making a new one when that's full
+static bool add_row(EcsArchetype_t* Archetype, uint32_t* ChunkIndex, uint32_t* Row)
+{
+	EcsChunk_t* Last = Archetype->ChunkCount ? Archetype->Chunks[Archetype->ChunkCount - 1] : NULL;
+
+	if (!Last || Last->Count == Archetype->ChunkCapacity)
+	{
+		if (Archetype->ChunkCount == Archetype->ChunkAllocated)
+		{
+			unsigned int Allocated = Archetype->ChunkAllocated ? Archetype->ChunkAllocated * 2 : 4;
+			EcsChunk_t** Chunks = realloc(Archetype->Chunks, Allocated * sizeof(EcsChunk_t*));
+
+			if (!Chunks)
+				return 0;
+
+			Archetype->Chunks = Chunks;
+			Archetype->ChunkAllocated = Allocated;
+		}
+
+		Last = Archetype->Spare ? Archetype->Spare : alloc_aligned(ECS_CHUNK_ALIGNMENT, ECS_CHUNK_SIZE);
+
+		if (!Last)
+			return 0;
+
+		Archetype->Spare = NULL;
+
+		Last->Archetype = Archetype;
+		Last->Count = 0;
+
+		Archetype->Chunks[Archetype->ChunkCount++] = Last;
+	}
+
+	*ChunkIndex = Archetype->ChunkCount - 1;
+	*Row = Last->Count++;
+
+	Archetype->EntityCount++;
+
+	return 1;
+}
+
+// Fills the hole with the archetype's very last row so chunks stay packed
+static void remove_row(EcsArchetype_t* Archetype, uint32_t ChunkIndex, uint32_t Row)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+	EcsChunk_t* Chunk = Archetype->Chunks[ChunkIndex];
+	EcsChunk_t* Last = Archetype->Chunks[Archetype->ChunkCount - 1];
+	uint32_t LastRow = Last->Count - 1;
+
+	if (Chunk != Last || Row != LastRow)
+	{
+		for (int c = 0; c < ECS_COMPONENT_COUNT; ++c)
+			if (Archetype->Mask & ECS_MASK(c))
+				memcpy(get_row(Chunk, c, Row), get_row(Last, c, LastRow), ComponentSizes[c]);
+
+		EcsEntity_t Moved = ogt_ecs_chunk_entities(Last)[LastRow];
+		ogt_ecs_chunk_entities(Chunk)[Row] = Moved;
+
+		EcsRecord_t* Record = &World->Records[get_ecs_index(Moved)];
+		Record->Chunk = ChunkIndex;
+		Record->Row = Row;
+	}
+
+	Last->Count--;
+	Archetype->EntityCount--;
+
+	if (Last->Count == 0)
+	{
+		Archetype->ChunkCount--;
+
+		if (Archetype->Spare)
+			free_aligned(Archetype->Spare);
+
+		Archetype->Spare = Last;
+	}
+}
+
+static void init_component(void* Data, EcsComponent_t Component)
+{
+	memset(Data, 0, ComponentSizes[Component]);
+
+	if (Component == ECS_TRANSFORM)
+		glm_mat4_identity(((EcsTransform_t*)Data)->Matrix);
+	else if (Component == ECS_COLOR)
+		glm_vec4_one((float*)Data);
+}
+
+static void release_component(void* Data, EcsComponent_t Component)
+{
+	if (Component == ECS_BODY)
+	{
+		EcsBody_t* Body = (EcsBody_t*)Data;
+
+		if (Body->Geometry)
+			dGeomDestroy(Body->Geometry);
+
+		if (Body->Body)
+			dBodyDestroy(Body->Body);
+	}
+	else if (Component == ECS_RENDERABLE)
+		ogt_release_model(((EcsRenderable_t*)Data)->Model);
+}
+
+static EcsRecord_t* get_record(EcsEntity_t Entity)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+	uint32_t Index = get_ecs_index(Entity);
+
+	if (Index >= World->RecordCount)
+		return NULL;
+
+	EcsRecord_t* Record = &World->Records[Index];
+
+	return Record->Archetype && Record->Entity == Entity ? Record : NULL;
+}
+
+static uint32_t claim_record()
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+
+	if (World->FreeHead != ECS_NO_INDEX)
+	{
+		uint32_t Index = World->FreeHead;
+
+		World->FreeHead = World->Records[Index].NextFree;
+
+		if (World->FreeHead == ECS_NO_INDEX)
+			World->FreeTail = ECS_NO_INDEX;
+
+		return Index;
+	}
+
+	if (World->RecordCount >= ECS_MAX_ENTITIES)
+	{
+		printf("Too many ECS entities! %u\n", World->RecordCount);
+		return ECS_NO_INDEX;
+	}
+
+	if (World->RecordCount == World->RecordCapacity)
+	{
+		uint32_t Capacity = World->RecordCapacity ? World->RecordCapacity * 2 : 1024;
+		EcsRecord_t* Records = realloc(World->Records, Capacity * sizeof(EcsRecord_t));
+
+		if (!Records)
+		{
+			printf("Failed to allocate for ECS entities! %u\n", World->RecordCount);
+			return ECS_NO_INDEX;
+		}
+
+		World->Records = Records;
+		World->RecordCapacity = Capacity;
+	}
+
+	uint32_t Index = World->RecordCount++;
+
+	World->Records[Index].Archetype = NULL;
+	World->Records[Index].Entity = (1u << ECS_INDEX_BITS) | Index;
+
+	return Index;
+}
+
+static void release_record(uint32_t Index)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+	EcsRecord_t* Record = &World->Records[Index];
+
+	Record->Archetype = NULL;
+	Record->Entity = next_ecs_entity(Record->Entity);
+	Record->NextFree = ECS_NO_INDEX;
+
+	if (World->FreeTail != ECS_NO_INDEX)
+		World->Records[World->FreeTail].NextFree = Index;
+	else
+		World->FreeHead = Index;
+
+	World->FreeTail = Index;
+}
+
+EcsEntity_t ogt_ecs_create(EcsMask_t Mask)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+
+	if (World->Querying)
+	{
+		printf("Tried to create an ECS entity during a query!\n");
+		return ECS_NULL_ENTITY;
+	}
+
+	EcsArchetype_t* Archetype = find_archetype(Mask);
+	uint32_t Index = Archetype ? claim_record() : ECS_NO_INDEX;
+
+	if (Index == ECS_NO_INDEX)
+		return ECS_NULL_ENTITY;
+
+	EcsRecord_t* Record = &World->Records[Index];
+
+	if (!add_row(Archetype, &Record->Chunk, &Record->Row))
+	{
+		printf("Failed to allocate for ECS chunk!\n");
+		release_record(Index);
+
+		return ECS_NULL_ENTITY;
+	}
+
+	Record->Archetype = Archetype;
+
+	EcsChunk_t* Chunk = Archetype->Chunks[Record->Chunk];
+
+	for (int c = 0; c < ECS_COMPONENT_COUNT; ++c)
+		if (Mask & ECS_MASK(c))
+			init_component(get_row(Chunk, c, Record->Row), c);
+
+	ogt_ecs_chunk_entities(Chunk)[Record->Row] = Record->Entity;
+
+	if (++World->EntityCount > World->PeakCount)
+		World->PeakCount = World->EntityCount;
+
+	return Record->Entity;
+}
+
+void ogt_ecs_destroy(EcsEntity_t Entity)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+	EcsRecord_t* Record = get_record(Entity);
+
+	if (!Record)
+		return;
+
+	if (World->Querying)
+	{
+		printf("Tried to destroy an ECS entity during a query!\n");
+		return;
+	}
+
+	EcsArchetype_t* Archetype = Record->Archetype;
+	EcsChunk_t* Chunk = Archetype->Chunks[Record->Chunk];
+
+	for (int c = 0; c < ECS_COMPONENT_COUNT; ++c)
+		if (Archetype->Mask & ECS_MASK(c))
+			release_component(get_row(Chunk, c, Record->Row), c);
+
+	remove_row(Archetype, Record->Chunk, Record->Row);
+	release_record(get_ecs_index(Entity));
+
+	World->EntityCount--;
+}
+
+bool ogt_ecs_alive(EcsEntity_t Entity)
+{
+	return get_record(Entity) != NULL;
+}
+
+bool ogt_ecs_set_mask(EcsEntity_t Entity, EcsMask_t Mask)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+	EcsRecord_t* Record = get_record(Entity);
+
+	if (!Record || World->Querying)
+		return 0;
+
+	EcsArchetype_t* From = Record->Archetype;
+
+	if (From->Mask == Mask)
+		return 1;
+
+	EcsArchetype_t* To = find_archetype(Mask);
+	uint32_t ChunkIndex, Row;
+
+	if (!To || !add_row(To, &ChunkIndex, &Row))
+		return 0;
+
+	EcsChunk_t* Old = From->Chunks[Record->Chunk];
+	EcsChunk_t* New = To->Chunks[ChunkIndex];
+
+	// Shared components move across, dropped ones are released and new ones start fresh
+	for (int c = 0; c < ECS_COMPONENT_COUNT; ++c)
+	{
+		bool Had = From->Mask & ECS_MASK(c);
+		bool Has = Mask & ECS_MASK(c);
+
+		if (Had && Has)
+			memcpy(get_row(New, c, Row), get_row(Old, c, Record->Row), ComponentSizes[c]);
+		else if (Had)
+			release_component(get_row(Old, c, Record->Row), c);
+		else if (Has)
+			init_component(get_row(New, c, Row), c);
+	}
+
+	ogt_ecs_chunk_entities(New)[Row] = Entity;
+
+	remove_row(From, Record->Chunk, Record->Row);
+
+	Record->Archetype = To;
+	Record->Chunk = ChunkIndex;
+	Record->Row = Row;
+
+	return 1;
+}
+
+void* ogt_ecs_get(EcsEntity_t Entity, EcsComponent_t Component)
+{
+	EcsRecord_t* Record = get_record(Entity);
+
+	if (!Record || !(Record->Archetype->Mask & ECS_MASK(Component)))
+		return NULL;
+
+	return get_row(Record->Archetype->Chunks[Record->Chunk], Component, Record->Row);
+}
+
+bool ogt_ecs_set_model(EcsEntity_t Entity, const char* Path)
+{
+	EcsRenderable_t* Renderable = ogt_ecs_get(Entity, ECS_RENDERABLE);
+
+	if (!Renderable)
+	{
+		printf("Tried to set model '%s' on an ECS entity without a renderable!\n", Path);
+		return 0;
+	}
+
+	ModelInfo_t* ModelInfo = ogt_get_model_info(Path);
+
+	if (!ModelInfo)
+	{
+		printf("Failed to set model '%s' for ECS entity %x\n", Path, Entity);
+		return 0;
+	}
+
+	// Released after taking the new reference, same as ogt_set_entity_model
+	ogt_release_model(Renderable->Model);
+
+	Renderable->Model = ModelInfo;
+	Renderable->Lod = 0;
+
+	EcsBody_t* Body = ogt_ecs_get(Entity, ECS_BODY);
+
+	if (Body && Body->Geometry && Body->Mass > 0)
+		Body->FitToModel = 1;
+
+	return 1;
+}
+
+void ogt_ecs_query(EcsMask_t Mask, EcsSystemFn System, void* Data)
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+
+	World->Querying = 1;
+
+	for (unsigned int i = 0; i < World->ArchetypeCount; ++i)
+	{
+		EcsArchetype_t* Archetype = &World->Archetypes[i];
+
+		if ((Archetype->Mask & Mask) != Mask)
+			continue;
+
+		for (unsigned int j = 0; j < Archetype->ChunkCount; ++j)
+			System(Archetype->Chunks[j], Data);
+	}
+
+	World->Querying = 0;
+}
+
+void* ogt_ecs_chunk_components(EcsChunk_t* Chunk, EcsComponent_t Component)
+{
+	if (!(Chunk->Archetype->Mask & ECS_MASK(Component)))
+		return NULL;
+
+	return (unsigned char*)Chunk + Chunk->Archetype->Offsets[Component];
+}
+
+EcsEntity_t* ogt_ecs_chunk_entities(EcsChunk_t* Chunk)
+{
+	return (EcsEntity_t*)((unsigned char*)Chunk + Chunk->Archetype->EntityOffset);
+}
+
+static void sync_bodies_system(EcsChunk_t* Chunk, void*)
+{
+	EcsTransform_t* Transforms = ogt_ecs_chunk_components(Chunk, ECS_TRANSFORM);
+	EcsBody_t* Bodies = ogt_ecs_chunk_components(Chunk, ECS_BODY);
+
+	for (unsigned int i = 0; i < Chunk->Count; ++i)
+		if (Bodies[i].Body)
+			ogt_sync_body(Bodies[i].Body, Transforms[i].Origin, Transforms[i].Angles);
+}
+
+static void fit_bodies_system(EcsChunk_t* Chunk, void*)
+{
+	EcsBody_t* Bodies = ogt_ecs_chunk_components(Chunk, ECS_BODY);
+	EcsRenderable_t* Renderables = ogt_ecs_chunk_components(Chunk, ECS_RENDERABLE);
+
+	for (unsigned int i = 0; i < Chunk->Count; ++i)
+		if (Bodies[i].FitToModel && ogt_fit_box_to_model(Bodies[i].Body, Bodies[i].Geometry, Renderables[i].Model, Bodies[i].Mass))
+			Bodies[i].FitToModel = 0;
+}
+
+static void build_transforms_system(EcsChunk_t* Chunk, void*)
+{
+	EcsTransform_t* Transforms = ogt_ecs_chunk_components(Chunk, ECS_TRANSFORM);
+
+	for (unsigned int i = 0; i < Chunk->Count; ++i)
+		ogt_build_entity_transform(Transforms[i].Origin, Transforms[i].Angles, Transforms[i].Matrix);
+}
+
+static void draw_system(EcsChunk_t* Chunk, void*)
+{
+	EcsTransform_t* Transforms = ogt_ecs_chunk_components(Chunk, ECS_TRANSFORM);
+	EcsRenderable_t* Renderables = ogt_ecs_chunk_components(Chunk, ECS_RENDERABLE);
+	vec4* Colors = ogt_ecs_chunk_components(Chunk, ECS_COLOR);
+
+	for (unsigned int i = 0; i < Chunk->Count; ++i)
+		if (Renderables[i].Model)
+			ogt_draw_model(Renderables[i].Model, Transforms[i].Matrix, Transforms[i].Origin, Colors ? Colors[i] : (float*)VEC3_ONE, &Renderables[i].Lod);
+}
+
+void ogt_ecs_update()
+{
+	ogt_ecs_query(ECS_MASK(ECS_TRANSFORM) | ECS_MASK(ECS_BODY), sync_bodies_system, NULL);
+	ogt_ecs_query(ECS_MASK(ECS_BODY) | ECS_MASK(ECS_RENDERABLE), fit_bodies_system, NULL);
+}
+
+void ogt_ecs_render()
+{
+	ogt_ecs_query(ECS_MASK(ECS_TRANSFORM), build_transforms_system, NULL);
+	ogt_ecs_query(ECS_MASK(ECS_TRANSFORM) | ECS_MASK(ECS_RENDERABLE), draw_system, NULL);
+}
+
+void ogt_print_ecs_stats()
+{
+	EcsWorld_t* World = GlobalVars->EcsWorld;
+	size_t ChunkCount = 0;
+
+	for (unsigned int i = 0; i < World->ArchetypeCount; ++i)
+		ChunkCount += World->Archetypes[i].ChunkCount + (World->Archetypes[i].Spare != NULL);
+
+	printf(
+		"ECS - Entities: %zu Peak: %zu Archetypes: %u Chunks: %zu (%zu bytes)\n",
+
+		World->EntityCount,
+		World->PeakCount,
+		World->ArchetypeCount,
+		ChunkCount,
+		ChunkCount * ECS_CHUNK_SIZE
+	);
+}
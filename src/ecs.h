@@ -0,0 +1,120 @@
+#ifndef ogt_ecs
+#define ogt_ecs
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cglm/types.h>
+
+#include "models.h"
+#include "physics.h"
+
+#define ECS_CHUNK_SIZE (16 * 1024) // Each chunk holds one array per component for as many rows as fit
+#define ECS_CHUNK_ALIGNMENT 64 // Chunks and the arrays inside them start on a cache line
+#define ECS_MAX_ARCHETYPES 64
+#define ECS_INDEX_BITS 20
+#define ECS_GENERATION_BITS (32 - ECS_INDEX_BITS)
+#define ECS_MAX_ENTITIES (1u << ECS_INDEX_BITS)
+#define ECS_NULL_ENTITY 0 // Generations start at 1 like entity handles
+#define ECS_NO_INDEX UINT32_MAX
+
+typedef enum
+{
+	ECS_TRANSFORM, // EcsTransform_t
+	ECS_BODY, // EcsBody_t
+	ECS_RENDERABLE, // EcsRenderable_t
+	ECS_COLOR, // vec4, only the rgb is used
+
+	ECS_COMPONENT_COUNT
+} EcsComponent_t;
+
+#define ECS_MASK(Component) (1u << (Component))
+
+typedef uint32_t EcsMask_t;
+typedef uint32_t EcsEntity_t; // Same index and generation packing as EntityHandle_t, but its own index space
+
+typedef struct
+{
+	vec4 Origin; // The w is padding
+	vec4 Angles; // Pitch, yaw, roll in degrees like entity angles
+	mat4 Matrix; // Built from the two above before rendering
+} EcsTransform_t;
+
+typedef struct
+{
+	dBodyID Body; // 0 for static geometry
+	dGeomID Geometry;
+	dReal Mass;
+	bool FitToModel; // Box geometry is resized to the renderable's bounds once it has loaded
+} EcsBody_t;
+
+typedef struct
+{
+	ModelInfo_t* Model; // Holds a reference, released when the component goes away
+	unsigned int Lod; // Kept between frames for hysteresis
+} EcsRenderable_t;
+
+typedef struct EcsArchetype_t EcsArchetype_t;
+
+typedef struct
+{
+	EcsArchetype_t* Archetype;
+	unsigned int Count;
+} EcsChunk_t; // Component arrays follow in the same allocation, at the archetype's offsets
+
+struct EcsArchetype_t
+{
+	EcsMask_t Mask;
+	unsigned int ChunkCapacity; // Rows per chunk
+	size_t Offsets[ECS_COMPONENT_COUNT]; // From the start of a chunk, only set for components in Mask
+	size_t EntityOffset;
+
+	EcsChunk_t** Chunks; // Every chunk but the last is full
+	unsigned int ChunkCount;
+	unsigned int ChunkAllocated;
+	EcsChunk_t* Spare; // Last emptied chunk, kept so churn at a chunk boundary doesn't hit the heap
+
+	size_t EntityCount;
+};
+
+typedef struct
+{
+	EcsArchetype_t* Archetype; // NULL while the slot is free
+	uint32_t Chunk;
+	uint32_t Row;
+	EcsEntity_t Entity; // Current handle, the generation changes on destroy
+	uint32_t NextFree;
+} EcsRecord_t;
+
+typedef struct
+{
+	EcsArchetype_t Archetypes[ECS_MAX_ARCHETYPES];
+	unsigned int ArchetypeCount;
+
+	EcsRecord_t* Records; // By entity index
+	uint32_t RecordCount;
+	uint32_t RecordCapacity;
+	uint32_t FreeHead; // Oldest first, same as the entity manager
+	uint32_t FreeTail;
+
+	size_t EntityCount;
+	size_t PeakCount;
+	bool Querying; // Structural changes during a query would move rows under it
+} EcsWorld_t;
+
+typedef void (*EcsSystemFn)(EcsChunk_t* Chunk, void* Data);
+
+void ogt_init_ecs();
+EcsEntity_t ogt_ecs_create(EcsMask_t Mask); // ECS_NULL_ENTITY on failure, components start zeroed with an identity matrix and white colour
+void ogt_ecs_destroy(EcsEntity_t Entity); // Releases the model and ODE objects it owns, stale handles are ignored
+bool ogt_ecs_alive(EcsEntity_t Entity);
+bool ogt_ecs_set_mask(EcsEntity_t Entity, EcsMask_t Mask); // Adds and removes components by moving it to another archetype
+bool ogt_ecs_set_model(EcsEntity_t Entity, const char* Path); // Renderable only, swaps the model reference
+void* ogt_ecs_get(EcsEntity_t Entity, EcsComponent_t Component); // NULL when dead or missing it, valid until the next create, destroy or mask change
+void ogt_ecs_query(EcsMask_t Mask, EcsSystemFn System, void* Data); // Every non-empty chunk with at least Mask, no structural changes from System
+void* ogt_ecs_chunk_components(EcsChunk_t* Chunk, EcsComponent_t Component); // NULL if its archetype doesn't have it
+EcsEntity_t* ogt_ecs_chunk_entities(EcsChunk_t* Chunk);
+void ogt_ecs_update(); // Physics sync and box fitting, once a frame next to ogt_think_entities
+void ogt_ecs_render(); // Builds transforms and draws renderables, call while a view is being rendered
+void ogt_print_ecs_stats();
+
+#endif
@@ -1,5 +1,7 @@
 #include "monkey.h"
 
+#include <cglm/cglm.h>
+
 #include "../globals.h"
 
 static void OnCreation(Entity_t* self)
@@ -14,22 +16,27 @@ static void OnDeletion(Entity_t* self)
 
 static void PhysicsInit(Entity_t* self)
 {
-	self->Body = dBodyCreate(GlobalVars->PhysicsManager->World);
-	dBodySetPosition(self->Body, self->Origin[0], self->Origin[1], self->Origin[2]);
-	dBodySetLinearVel(self->Body, 0, 0, 0);
-	dBodySetAngularVel(self->Body, 0, 0, 0);
+	float* Origin = ogt_get_entity_origin(self);
+	dBodyID Body = dBodyCreate(GlobalVars->PhysicsManager->World);
+	dBodySetPosition(Body, Origin[0], Origin[1], Origin[2]);
+	dBodySetLinearVel(Body, 0, 0, 0);
+	dBodySetAngularVel(Body, 0, 0, 0);
 
 	dMass Mass;
 	dMassSetBox(&Mass, 1.0, 1.0, 1.0, 1.0);
-	dBodySetMass(self->Body, &Mass);
+	dBodySetMass(Body, &Mass);
+
+	// Placeholder until the model has loaded, Think fits it to the model bounds
+	dGeomID Geometry = dCreateBox(GlobalVars->PhysicsManager->Space, 1.0, 1.0, 1.0);
+	dGeomSetBody(Geometry, Body);
 
-	self->Geometry = dCreateBox(GlobalVars->PhysicsManager->Space, 1.0, 1.0, 1.0);
-	dGeomSetBody(self->Geometry, self->Body);
+	ogt_set_entity_body(self, Body);
+	ogt_set_entity_geometry(self, Geometry);
 }
 
 static void Think(Entity_t* self, float DeltaTime)
 {
-
+	ogt_fit_entity_box(self, 1.0);
 }
 
 static void Render(Entity_t* self, float DeltaTime)
@@ -52,3 +59,31 @@ EntityClass_t* ogt_register_ent_monkey()
 
 	return ogt_register_entity_class("monkey", Callbacks);
 }
+
+EcsEntity_t ogt_spawn_ecs_monkey(vec3 Origin)
+{
+	EcsEntity_t Entity = ogt_ecs_create(ECS_MASK(ECS_TRANSFORM) | ECS_MASK(ECS_BODY) | ECS_MASK(ECS_RENDERABLE) | ECS_MASK(ECS_COLOR));
+
+	if (Entity == ECS_NULL_ENTITY)
+		return ECS_NULL_ENTITY;
+
+	EcsTransform_t* Transform = ogt_ecs_get(Entity, ECS_TRANSFORM);
+	EcsBody_t* Body = ogt_ecs_get(Entity, ECS_BODY);
+
+	glm_vec3_copy(Origin, Transform->Origin);
+
+	Body->Body = dBodyCreate(GlobalVars->PhysicsManager->World);
+	dBodySetPosition(Body->Body, Origin[0], Origin[1], Origin[2]);
+
+	dMass Mass;
+	dMassSetBox(&Mass, 1.0, 1.0, 1.0, 1.0);
+	dBodySetMass(Body->Body, &Mass);
+
+	Body->Geometry = dCreateBox(GlobalVars->PhysicsManager->Space, 1.0, 1.0, 1.0);
+	dGeomSetBody(Body->Geometry, Body->Body);
+	Body->Mass = 1.0;
+
+	ogt_ecs_set_model(Entity, "../src/models/spongekey.obj"); // Also flags the box to be fitted once it loads
+
+	return Entity;
+}
@@ -2,7 +2,9 @@
 #define ogt_ent_monkey
 
 #include "../ents.h"
+#include "../ecs.h"
 
 EntityClass_t* ogt_register_ent_monkey();
+EcsEntity_t ogt_spawn_ecs_monkey(vec3 Origin); // Same monkey on the ECS, the body and render systems stand in for its callbacks
 
 #endif
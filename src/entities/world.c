@@ -16,8 +16,9 @@ static void OnDeletion(Entity_t* self)
 
 static void PhysicsInit(Entity_t* self)
 {
-	self->Geometry = dCreateBox(GlobalVars->PhysicsManager->Space, 15, 1.0, 15);
-	dGeomSetBody(self->Geometry, self->Body);
+	dGeomID Geometry = dCreateBox(GlobalVars->PhysicsManager->Space, 15, 1.0, 15);
+	dGeomSetBody(Geometry, ogt_get_entity_body(self));
+	ogt_set_entity_geometry(self, Geometry);
 }
 
 static void Think(Entity_t* self, float DeltaTime)
@@ -43,5 +44,25 @@ EntityClass_t* ogt_register_ent_world()
 	Callbacks->Think = Think;
 	Callbacks->Render = Render;
 
-	return ogt_register_entity_class("world", Callbacks);
+	EntityClass_t* Class = ogt_register_entity_class("world", Callbacks);
+
+	if (Class)
+		Class->ParallelThink = 1; // Think doesn't do anything yet
+
+	return Class;
+}
+
+EcsEntity_t ogt_spawn_ecs_world()
+{
+	EcsEntity_t Entity = ogt_ecs_create(ECS_MASK(ECS_TRANSFORM) | ECS_MASK(ECS_BODY) | ECS_MASK(ECS_RENDERABLE) | ECS_MASK(ECS_COLOR));
+
+	if (Entity == ECS_NULL_ENTITY)
+		return ECS_NULL_ENTITY;
+
+	EcsBody_t* Body = ogt_ecs_get(Entity, ECS_BODY);
+	Body->Geometry = dCreateBox(GlobalVars->PhysicsManager->Space, 15, 1.0, 15);
+
+	ogt_ecs_set_model(Entity, "../src/models/playne.obj");
+
+	return Entity;
 }
@@ -2,7 +2,9 @@
 #define ogt_ent_world
 
 #include "../ents.h"
+#include "../ecs.h"
 
 EntityClass_t* ogt_register_ent_world();
+EcsEntity_t ogt_spawn_ecs_world(); // Static floor on the ECS, no body so physics never moves it
 
 #endif
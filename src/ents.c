@@ -10,6 +10,7 @@
 #include <cglm/types.h>
 
 #include "globals.h"
+#include "jobs.h"
 #include "util.h"
 
 void ogt_init_entity_system()
@@ -23,17 +24,164 @@ void ogt_init_entity_system()
 	}
 
 	GlobalVars->EntityManager->EntIndex = 0;
-	GlobalVars->EntityManager->FreeIndexCount = 0;
+	GlobalVars->EntityManager->EntityCount = 0;
+	GlobalVars->EntityManager->Live = NULL;
+	GlobalVars->EntityManager->LiveCapacity = 0;
+	memset(&GlobalVars->EntityManager->Components, 0, sizeof(EntityComponents_t));
+	GlobalVars->EntityManager->Blocks = NULL;
+	GlobalVars->EntityManager->BlockCount = 0;
 	GlobalVars->EntityManager->EntityClassMap = hashmap_create();
 	GlobalVars->EntityManager->EntityModelMap = hashmap_create();
+	GlobalVars->EntityManager->FreeHead = ENTITY_NO_INDEX;
+	GlobalVars->EntityManager->FreeTail = ENTITY_NO_INDEX;
+	GlobalVars->EntityManager->ThinkHandles = NULL;
+	GlobalVars->EntityManager->ThinkBatches = NULL;
+	GlobalVars->EntityManager->ThinkBatchCapacity = 0;
+	GlobalVars->EntityManager->ThinkingInParallel = 0;
+	GlobalVars->EntityManager->FreeCount = 0;
+	GlobalVars->EntityManager->PeakCount = 0;
+
+	init_arena(&GlobalVars->EntityManager->ClassArena, ARENA_BLOCK_SIZE);
+}
+
+static inline Entity_t* get_entity_slot(unsigned int Index)
+{
+	return &GlobalVars->EntityManager->Blocks[Index / ENTITY_BLOCK_SIZE][Index % ENTITY_BLOCK_SIZE];
+}
+
+static inline unsigned int get_handle_index(EntityHandle_t Handle)
+{
+	return Handle & (MAX_ENTITIES - 1);
+}
+
+static inline EntityHandle_t next_entity_handle(EntityHandle_t Handle)
+{
+	uint32_t Generation = (Handle >> ENTITY_INDEX_BITS) + 1;
+
+	if (Generation >= (1u << ENTITY_GENERATION_BITS))
+		Generation = 1; // Skips 0 so ENTITY_NULL_HANDLE never comes back
+
+	return (Generation << ENTITY_INDEX_BITS) | get_handle_index(Handle);
+}
+
+// Moves Count entries into a new aligned array of Capacity, the old one is only freed on success
+static bool grow_component(void** Data, size_t Count, size_t Capacity, size_t Size)
+{
+	void* Grown = alloc_aligned(ENTITY_COMPONENT_ALIGNMENT, Capacity * Size);
+
+	if (!Grown)
+		return 0;
+
+	if (Count)
+		memcpy(Grown, *Data, Count * Size);
+
+	free_aligned(*Data);
+	*Data = Grown;
+
+	return 1;
+}
+
+static bool grow_entity_components(unsigned int Capacity)
+{
+	EntityComponents_t* Components = &GlobalVars->EntityManager->Components;
+	unsigned int Count = GlobalVars->EntityManager->EntityCount;
+
+	return grow_component((void**)&Components->Origins, Count, Capacity, sizeof(vec4))
+		&& grow_component((void**)&Components->Angles, Count, Capacity, sizeof(vec4))
+		&& grow_component((void**)&Components->Colors, Count, Capacity, sizeof(vec4))
+		&& grow_component((void**)&Components->Bodies, Count, Capacity, sizeof(dBodyID))
+		&& grow_component((void**)&Components->Geometries, Count, Capacity, sizeof(dGeomID))
+		&& grow_component((void**)&Components->Transforms, Count, Capacity, sizeof(mat4));
+}
+
+static bool grow_entity_blocks()
+{
+	EntityManager_t* Manager = GlobalVars->EntityManager;
+	Entity_t** Blocks = realloc(Manager->Blocks, (Manager->BlockCount + 1) * sizeof(Entity_t*));
+
+	if (!Blocks)
+		return 0;
+
+	Manager->Blocks = Blocks;
+
+	// Kept at least as big as the slots so adding to the live list can't fail later, doubled so growing stays linear overall
+	unsigned int SlotCount = (Manager->BlockCount + 1) * ENTITY_BLOCK_SIZE;
+
+	if (SlotCount > Manager->LiveCapacity)
+	{
+		unsigned int Capacity = Manager->LiveCapacity * 2 > SlotCount ? Manager->LiveCapacity * 2 : SlotCount;
+		Entity_t** Live = realloc(Manager->Live, Capacity * sizeof(Entity_t*));
+
+		if (!Live)
+			return 0;
+
+		Manager->Live = Live;
+
+		EntityHandle_t* ThinkHandles = realloc(Manager->ThinkHandles, Capacity * sizeof(EntityHandle_t));
+
+		if (!ThinkHandles)
+			return 0;
+
+		Manager->ThinkHandles = ThinkHandles;
+
+		if (!grow_entity_components(Capacity))
+			return 0;
+
+		Manager->LiveCapacity = Capacity;
+	}
+
+	Entity_t* Block = alloc_aligned(ENTITY_CACHE_LINE, ENTITY_BLOCK_SIZE * sizeof(Entity_t));
+
+	if (!Block)
+		return 0;
+
+	Manager->Blocks[Manager->BlockCount++] = Block;
+
+	return 1;
+}
+
+static unsigned int claim_entity_slot()
+{
+	EntityManager_t* Manager = GlobalVars->EntityManager;
+
+	if (Manager->FreeHead != ENTITY_NO_INDEX)
+	{
+		unsigned int Index = Manager->FreeHead;
+
+		Manager->FreeHead = get_entity_slot(Index)->NextFree;
+
+		if (Manager->FreeHead == ENTITY_NO_INDEX)
+			Manager->FreeTail = ENTITY_NO_INDEX;
+
+		Manager->FreeCount--;
+
+		return Index;
+	}
+
+	if (Manager->EntIndex >= MAX_ENTITIES)
+	{
+		printf("Too many entities! %u\n", Manager->EntIndex);
+		return ENTITY_NO_INDEX;
+	}
+
+	if (Manager->EntIndex >= Manager->BlockCount * ENTITY_BLOCK_SIZE && !grow_entity_blocks())
+	{
+		printf("Failed to allocate for entities! %u\n", Manager->EntIndex);
+		return ENTITY_NO_INDEX;
+	}
+
+	unsigned int Index = Manager->EntIndex++;
+	Entity_t* Slot = get_entity_slot(Index);
+
+	Slot->Valid = 0;
+	Slot->Handle = (1u << ENTITY_INDEX_BITS) | Index;
 
-	for (unsigned int i = 0; i < MAX_ENTITIES; ++i)
-		GlobalVars->EntityManager->FreeEntIndices[i] = i;
+	return Index;
 }
 
 EntityCallbacks_t* ogt_init_entity_callbacks()
 {
-	EntityCallbacks_t* Callbacks = (EntityCallbacks_t*)malloc(sizeof(EntityCallbacks_t));
+	EntityCallbacks_t* Callbacks = (EntityCallbacks_t*)arena_alloc(&GlobalVars->EntityManager->ClassArena, sizeof(EntityCallbacks_t));
 
 	if (!Callbacks)
 	{
@@ -42,8 +190,6 @@ EntityCallbacks_t* ogt_init_entity_callbacks()
 		return NULL;
 	}
 
-	memset(Callbacks, 0, sizeof(Callbacks));
-
 	return Callbacks;
 }
 
@@ -58,7 +204,7 @@ EntityClass_t* ogt_register_entity_class(const char* Class, EntityCallbacks_t* C
 		return NULL;
 	}
 
-	EntityClass_t* EntityClass = (EntityClass_t*)malloc(sizeof(EntityClass_t));
+	EntityClass_t* EntityClass = (EntityClass_t*)arena_alloc(&GlobalVars->EntityManager->ClassArena, sizeof(EntityClass_t));
 
 	if (!EntityClass)
 	{
@@ -70,6 +216,7 @@ EntityClass_t* ogt_register_entity_class(const char* Class, EntityCallbacks_t* C
 	EntityClass->Name = Class;
 
 	EntityClass->Callbacks = Callbacks;
+	EntityClass->ParallelThink = 0;
 
 	hashmap_set(GlobalVars->EntityManager->EntityClassMap, Class, strlen(Class), (uintptr_t)EntityClass);
 
@@ -86,46 +233,49 @@ EntityClass_t* ogt_find_entity_class(const char* Class)
 	return NULL;
 }
 
-Entity_t* ogt_create_entity_ex(EntityClass_t* EntityClass)
+EntityHandle_t ogt_create_entity_handle(EntityClass_t* EntityClass)
 {
-	unsigned int EntityIndex;
-
-	if (GlobalVars->EntityManager->FreeIndexCount > 0)
-		EntityIndex = GlobalVars->EntityManager->FreeEntIndices[--GlobalVars->EntityManager->FreeIndexCount];
-	else
+	if (GlobalVars->EntityManager->ThinkingInParallel)
 	{
-		if (GlobalVars->EntityManager->EntIndex >= MAX_ENTITIES)
-		{
-			printf("Too many entities! %d\n", GlobalVars->EntityManager->EntIndex);
-			return NULL;
-		}
+		printf("Trying to create entity of class '%s' from a parallel think\n", EntityClass->Name);
 
-		EntityIndex = GlobalVars->EntityManager->EntIndex++;
+		return ENTITY_NULL_HANDLE;
 	}
 
-	Entity_t* Entity = (Entity_t*)malloc(sizeof(Entity_t));
+	unsigned int EntityIndex = claim_entity_slot();
 
-	if (!Entity)
-	{
-		printf("Failed to allocate for entity of class '%s'\n", EntityClass->Name);
+	if (EntityIndex == ENTITY_NO_INDEX)
+		return ENTITY_NULL_HANDLE;
 
-		return NULL;
-	}
+	Entity_t* Entity = get_entity_slot(EntityIndex);
 
 	Entity->Valid = 1;
 	Entity->Index = EntityIndex;
+	Entity->NextFree = ENTITY_NO_INDEX;
 
 	Entity->ClassInfo = EntityClass;
 	Entity->ModelInfo = NULL;
+	Entity->Lod = 0;
+
+	Entity->GeometryFitted = 0;
 
-	Entity->Body = 0;
-	Entity->Geometry = 0;
+	EntityComponents_t* Components = &GlobalVars->EntityManager->Components;
+	unsigned int LiveIndex = GlobalVars->EntityManager->EntityCount++;
 
-	memset(&Entity->Origin, 0, sizeof(vec3));
-	memset(&Entity->Angles, 0, sizeof(vec3));
-	glm_vec3_one(Entity->Color);
+	Entity->LiveIndex = LiveIndex;
+	GlobalVars->EntityManager->Live[LiveIndex] = Entity;
 
-	GlobalVars->EntityManager->Entities[EntityIndex] = Entity;
+	if (GlobalVars->EntityManager->EntityCount > GlobalVars->EntityManager->PeakCount)
+		GlobalVars->EntityManager->PeakCount = GlobalVars->EntityManager->EntityCount;
+
+	glm_vec4_zero(Components->Origins[LiveIndex]);
+	glm_vec4_zero(Components->Angles[LiveIndex]);
+	glm_vec4_one(Components->Colors[LiveIndex]);
+	Components->Bodies[LiveIndex] = 0;
+	Components->Geometries[LiveIndex] = 0;
+	glm_mat4_identity(Components->Transforms[LiveIndex]);
+
+	EntityHandle_t Handle = Entity->Handle;
 
 	if (Entity->ClassInfo->Callbacks->OnCreation)
 		Entity->ClassInfo->Callbacks->OnCreation(Entity);
@@ -133,7 +283,12 @@ Entity_t* ogt_create_entity_ex(EntityClass_t* EntityClass)
 	if (Entity->ClassInfo->Callbacks->InitPhysics)
 		Entity->ClassInfo->Callbacks->InitPhysics(Entity);
 
-	return Entity;
+	return Handle;
+}
+
+Entity_t* ogt_create_entity_ex(EntityClass_t* EntityClass)
+{
+	return ogt_get_entity(ogt_create_entity_handle(EntityClass)); // NULL if a callback already deleted it
 }
 
 Entity_t* ogt_create_entity(const char* Class)
@@ -150,69 +305,328 @@ Entity_t* ogt_create_entity(const char* Class)
 	return ogt_create_entity_ex(EntityClass);
 }
 
+Entity_t* ogt_get_entity(EntityHandle_t Handle)
+{
+	unsigned int Index = get_handle_index(Handle);
+
+	if (Index >= GlobalVars->EntityManager->EntIndex)
+		return NULL;
+
+	Entity_t* Entity = get_entity_slot(Index);
+
+	return Entity->Valid && Entity->Handle == Handle ? Entity : NULL;
+}
+
+bool ogt_is_entity_valid(EntityHandle_t Handle)
+{
+	return ogt_get_entity(Handle) != NULL;
+}
+
+void ogt_delete_entity_handle(EntityHandle_t Handle)
+{
+	Entity_t* Entity = ogt_get_entity(Handle);
+
+	if (Entity)
+		ogt_delete_entity(Entity);
+}
+
 void ogt_delete_entity(Entity_t* Entity)
 {
+	if (GlobalVars->EntityManager->ThinkingInParallel)
+	{
+		printf("Trying to delete entity %u from a parallel think\n", Entity->Index);
+
+		return;
+	}
+
 	if (Entity->Valid)
 	{
+		EntityManager_t* Manager = GlobalVars->EntityManager;
+
 		if (Entity->ClassInfo->Callbacks->OnDeletion)
 			Entity->ClassInfo->Callbacks->OnDeletion(Entity);
 
 		unsigned int EntityIndex = Entity->Index;
 
+		ogt_release_model(Entity->ModelInfo);
+		Entity->ModelInfo = NULL;
+
 		Entity->Valid = 0;
 		Entity->Index = 0;
 		Entity->ClassInfo = NULL;
+		Entity->Handle = next_entity_handle(Entity->Handle); // Outstanding handles stop resolving here
+
+		Entity->NextFree = ENTITY_NO_INDEX;
 
-		GlobalVars->EntityManager->Entities[EntityIndex] = NULL;
-		GlobalVars->EntityManager->FreeEntIndices[GlobalVars->EntityManager->FreeIndexCount++] = EntityIndex;
+		if (Manager->FreeTail != ENTITY_NO_INDEX)
+			get_entity_slot(Manager->FreeTail)->NextFree = EntityIndex;
+		else
+			Manager->FreeHead = EntityIndex;
+
+		Manager->FreeTail = EntityIndex;
+		Manager->FreeCount++;
+
+		EntityComponents_t* Components = &Manager->Components;
+		unsigned int Hole = Entity->LiveIndex;
+		unsigned int LastIndex = --Manager->EntityCount;
+		Entity_t* Last = Manager->Live[LastIndex];
+
+		Manager->Live[Hole] = Last;
+		Last->LiveIndex = Hole;
+
+		glm_vec4_copy(Components->Origins[LastIndex], Components->Origins[Hole]);
+		glm_vec4_copy(Components->Angles[LastIndex], Components->Angles[Hole]);
+		glm_vec4_copy(Components->Colors[LastIndex], Components->Colors[Hole]);
+		Components->Bodies[Hole] = Components->Bodies[LastIndex];
+		Components->Geometries[Hole] = Components->Geometries[LastIndex];
+		glm_mat4_copy(Components->Transforms[LastIndex], Components->Transforms[Hole]);
 	}
 }
 
-void ogt_think_entities(float DeltaTime)
+float* ogt_get_entity_origin(Entity_t* Entity)
+{
+	return GlobalVars->EntityManager->Components.Origins[Entity->LiveIndex];
+}
+
+float* ogt_get_entity_angles(Entity_t* Entity)
+{
+	return GlobalVars->EntityManager->Components.Angles[Entity->LiveIndex];
+}
+
+float* ogt_get_entity_color(Entity_t* Entity)
+{
+	return GlobalVars->EntityManager->Components.Colors[Entity->LiveIndex];
+}
+
+dBodyID ogt_get_entity_body(Entity_t* Entity)
+{
+	return GlobalVars->EntityManager->Components.Bodies[Entity->LiveIndex];
+}
+
+void ogt_set_entity_body(Entity_t* Entity, dBodyID Body)
+{
+	GlobalVars->EntityManager->Components.Bodies[Entity->LiveIndex] = Body;
+}
+
+dGeomID ogt_get_entity_geometry(Entity_t* Entity)
 {
-	for (unsigned int i = 0; i < GlobalVars->EntityManager->EntIndex; ++i)
+	return GlobalVars->EntityManager->Components.Geometries[Entity->LiveIndex];
+}
+
+void ogt_set_entity_geometry(Entity_t* Entity, dGeomID Geometry)
+{
+	GlobalVars->EntityManager->Components.Geometries[Entity->LiveIndex] = Geometry;
+}
+
+static void sync_entity_bodies()
+{
+	EntityComponents_t* Components = &GlobalVars->EntityManager->Components;
+	unsigned int Count = GlobalVars->EntityManager->EntityCount;
+
+	for (unsigned int i = 0; i < Count; ++i)
 	{
-		Entity_t* Entity = GlobalVars->EntityManager->Entities[i];
+		dBodyID Body = Components->Bodies[i];
 
-		if (Entity->Valid && Entity->Body)
-		{
-			const dReal* Pos = dBodyGetPosition(Entity->Body);
-			glm_vec3_copy((vec3){ Pos[0], Pos[1], Pos[2] }, Entity->Origin);
+		if (Body)
+			ogt_sync_body(Body, Components->Origins[i], Components->Angles[i]);
+	}
+}
+
+// Translation then rotations about VEC3_RIGHT, VEC3_UP and VEC3_FORWARD in that order, which are -Z, Y and X.
+// Written out in closed form, it's three sines and cosines instead of three matrix products
+void ogt_build_entity_transform(const float* Origin, const float* Angles, mat4 Transform)
+{
+	float Z = -glm_rad(Angles[0]), Y = glm_rad(Angles[1]), X = glm_rad(Angles[2]);
+	float SZ = sinf(Z), CZ = cosf(Z);
+	float SY = sinf(Y), CY = cosf(Y);
+	float SX = sinf(X), CX = cosf(X);
+
+	Transform[0][0] = CY * CZ;
+	Transform[0][1] = CY * SZ;
+	Transform[0][2] = -SY;
+	Transform[0][3] = 0.f;
+
+	Transform[1][0] = CZ * SY * SX - SZ * CX;
+	Transform[1][1] = SZ * SY * SX + CZ * CX;
+	Transform[1][2] = CY * SX;
+	Transform[1][3] = 0.f;
+
+	Transform[2][0] = CZ * SY * CX + SZ * SX;
+	Transform[2][1] = SZ * SY * CX - CZ * SX;
+	Transform[2][2] = CY * CX;
+	Transform[2][3] = 0.f;
+
+	Transform[3][0] = Origin[0];
+	Transform[3][1] = Origin[1];
+	Transform[3][2] = Origin[2];
+	Transform[3][3] = 1.f;
+}
+
+void ogt_update_entity_transforms()
+{
+	EntityComponents_t* Components = &GlobalVars->EntityManager->Components;
+	unsigned int Count = GlobalVars->EntityManager->EntityCount;
 
-			const dReal* AngularVelocity = dBodyGetAngularVel(Entity->Body);
-			dBodySetAngularVel(Entity->Body, AngularVelocity[0] * 0.98f, AngularVelocity[1] * 0.98f, AngularVelocity[2] * 0.98f); // SLOW THE FUCK DOWN
+	for (unsigned int i = 0; i < Count; ++i)
+		ogt_build_entity_transform(Components->Origins[i], Components->Angles[i], Components->Transforms[i]);
+}
 
-			const dReal* Rot = dBodyGetQuaternion(Entity->Body);
-			versor Q = { Rot[1], Rot[2], Rot[3], Rot[0] };
+static void think_entity_batch(void* Data)
+{
+	EntityThinkBatch_t* Batch = (EntityThinkBatch_t*)Data;
+	Entity_t** Live = GlobalVars->EntityManager->Live;
 
-			vec3 Euler;
-			quat_to_euler_deg(Q, Euler);
-			glm_vec3_scale(Euler, (float)(180.0 / M_PI), Entity->Angles);
+	for (unsigned int i = Batch->Start; i < Batch->End; ++i)
+	{
+		EntityClass_t* Class = Live[i]->ClassInfo;
+
+		if (Class->ParallelThink && Class->Callbacks->Think)
+			Class->Callbacks->Think(Live[i], Batch->DeltaTime);
+	}
+}
 
-			normalize_angles(Entity->Angles);
+// The live list can't change while these run, so it's split into fixed ranges up front
+static void think_entities_parallel(float DeltaTime)
+{
+	EntityManager_t* Manager = GlobalVars->EntityManager;
+	unsigned int BatchCount = (Manager->EntityCount + ENTITY_THINK_BATCH_SIZE - 1) / ENTITY_THINK_BATCH_SIZE;
+
+	if (BatchCount > Manager->ThinkBatchCapacity)
+	{
+		EntityThinkBatch_t* Batches = realloc(Manager->ThinkBatches, BatchCount * sizeof(EntityThinkBatch_t));
+
+		if (Batches)
+		{
+			Manager->ThinkBatches = Batches;
+			Manager->ThinkBatchCapacity = BatchCount;
 		}
 	}
 
-	for (unsigned int i = 0; i < GlobalVars->EntityManager->EntIndex; ++i)
+	// Not worth handing off a single batch, and without room for the batches just do them all here
+	if (BatchCount <= 1 || BatchCount > Manager->ThinkBatchCapacity || ogt_get_worker_count() == 0)
+	{
+		EntityThinkBatch_t Batch = { 0, Manager->EntityCount, DeltaTime };
+
+		Manager->ThinkingInParallel = 1;
+		think_entity_batch(&Batch);
+		Manager->ThinkingInParallel = 0;
+
+		return;
+	}
+
+	JobCounter_t Counter = { 0 };
+
+	Manager->ThinkingInParallel = 1;
+
+	for (unsigned int i = 0; i < BatchCount; ++i)
+	{
+		EntityThinkBatch_t* Batch = &Manager->ThinkBatches[i];
+
+		Batch->Start = i * ENTITY_THINK_BATCH_SIZE;
+		Batch->End = Batch->Start + ENTITY_THINK_BATCH_SIZE < Manager->EntityCount ? Batch->Start + ENTITY_THINK_BATCH_SIZE : Manager->EntityCount;
+		Batch->DeltaTime = DeltaTime;
+
+		ogt_submit_job(think_entity_batch, Batch, &Counter);
+	}
+
+	ogt_wait_for_jobs(&Counter);
+
+	Manager->ThinkingInParallel = 0;
+}
+
+void ogt_think_entities(float DeltaTime)
+{
+	EntityManager_t* Manager = GlobalVars->EntityManager;
+
+	sync_entity_bodies();
+
+	// Serial thinks can create and delete entities, which reorders the live list under the loop.
+	// Walking handles taken up front means everything alive now thinks once, and deleted ones are skipped
+	unsigned int ThinkCount = 0;
+
+	for (unsigned int i = 0; i < Manager->EntityCount; ++i)
+	{
+		Entity_t* Entity = Manager->Live[i];
+		EntityClass_t* Class = Entity->ClassInfo;
+
+		if (!Class->ParallelThink && Class->Callbacks->Think)
+			Manager->ThinkHandles[ThinkCount++] = Entity->Handle;
+	}
+
+	// Creating can grow the handle array, so it's looked up again every time
+	for (unsigned int i = 0; i < ThinkCount; ++i)
 	{
-		Entity_t* Entity = GlobalVars->EntityManager->Entities[i];
+		Entity_t* Entity = ogt_get_entity(Manager->ThinkHandles[i]);
 
-		if (Entity->Valid && Entity->ClassInfo->Callbacks->Think)
-		Entity->ClassInfo->Callbacks->Think(Entity, DeltaTime);
+		if (Entity)
+			Entity->ClassInfo->Callbacks->Think(Entity, DeltaTime);
 	}
+
+	// Parallel entities the serial thinks spawned still think this frame
+
+	think_entities_parallel(DeltaTime);
 }
 
 void ogt_render_entities(float DeltaTime)
 {
-	for (unsigned int i = 0; i < GlobalVars->EntityManager->EntIndex; ++i)
+	EntityManager_t* Manager = GlobalVars->EntityManager;
+
+	ogt_update_entity_transforms();
+
+	for (unsigned int i = 0; i < Manager->EntityCount; ++i)
 	{
-		Entity_t* Entity = GlobalVars->EntityManager->Entities[i];
+		Entity_t* Entity = Manager->Live[i];
 
-		if (Entity->Valid && Entity->ClassInfo->Callbacks->Render)
+		if (Entity->ClassInfo->Callbacks->Render)
 			Entity->ClassInfo->Callbacks->Render(Entity, DeltaTime);
 	}
 }
 
+static unsigned int select_model_lod(const ModelInfo_t* ModelInfo, const float* Origin, unsigned int* CurrentLod)
+{
+	const RenderView_t* View = GlobalVars->CurrentView;
+
+	if (!View || ModelInfo->LodCount <= 1)
+		return 0;
+
+	// Bounding sphere around the origin, so it holds however the model is rotated
+	float ModelRadius = get_model_radius(ModelInfo);
+	float BoundsRadius = glm_vec3_norm((float*)ModelInfo->SphereCenter) + ModelInfo->SphereRadius;
+	float Distance = glm_vec3_distance((float*)Origin, (float*)View->Origin) - BoundsRadius;
+
+	if (Distance <= View->NearZ)
+		return *CurrentLod = 0;
+
+	float PixelsPerUnit = (GlobalVars->WindowHeight * .5f) / (Distance * tanf(glm_rad(View->FOV) * .5f));
+	float PixelsPerError = ModelRadius * PixelsPerUnit;
+	unsigned int Lod = *CurrentLod < ModelInfo->LodCount ? *CurrentLod : (unsigned int)ModelInfo->LodCount - 1;
+
+	while (Lod + 1 < ModelInfo->LodCount && ModelInfo->LodErrors[Lod + 1] * PixelsPerError <= MODEL_LOD_PIXEL_ERROR * (1.f - MODEL_LOD_HYSTERESIS))
+		Lod++;
+
+	while (Lod > 0 && ModelInfo->LodErrors[Lod] * PixelsPerError > MODEL_LOD_PIXEL_ERROR * (1.f + MODEL_LOD_HYSTERESIS))
+		Lod--;
+
+	return *CurrentLod = Lod;
+}
+
+// Rough pixel height of the model's bounding sphere, what texture streaming sizes mips against
+static float get_model_screen_size(const ModelInfo_t* ModelInfo, const float* Origin)
+{
+	const RenderView_t* View = GlobalVars->CurrentView;
+
+	if (!View)
+		return 0.f;
+
+	float BoundsRadius = glm_vec3_norm((float*)ModelInfo->SphereCenter) + ModelInfo->SphereRadius;
+	float Distance = glm_vec3_distance((float*)Origin, (float*)View->Origin) - BoundsRadius;
+
+	if (Distance <= View->NearZ)
+		return (float)GlobalVars->WindowHeight;
+
+	return BoundsRadius * 2.f * (GlobalVars->WindowHeight * .5f) / (Distance * tanf(glm_rad(View->FOV) * .5f));
+}
+
 void ogt_render_entity_basic(Entity_t* Entity, float DeltaTime)
 {
 	if (!Entity->Valid)
@@ -229,32 +643,46 @@ void ogt_render_entity_basic(Entity_t* Entity, float DeltaTime)
 		return;
 	}
 
-	if (!ModelInfo->VAO || !ModelInfo->VBO)
+	if (ModelInfo->State == MODEL_STATE_READY && !ModelInfo->HasGeometry)
 	{
-		printf("Tried to render entity with invalid VAO/VBO! %d ('%s')\n", Entity->Index, Entity->ClassInfo->Name);
+		printf("Tried to render entity with no geometry! %d ('%s')\n", Entity->Index, Entity->ClassInfo->Name);
 		return;
 	}
 
+	ogt_draw_model(ModelInfo, GlobalVars->EntityManager->Components.Transforms[Entity->LiveIndex], ogt_get_entity_origin(Entity), ogt_get_entity_color(Entity), &Entity->Lod);
+}
+
+void ogt_draw_model(ModelInfo_t* ModelInfo, mat4 Transform, const float* Origin, const float* Color, unsigned int* Lod)
+{
+	if (ModelInfo->State != MODEL_STATE_READY || !ModelInfo->HasGeometry)
+		return; // Still loading, or failed and already reported
+
 	unsigned int ShaderProgram;
 	glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&ShaderProgram);
 
-	glUniform3fv(glGetUniformLocation(ShaderProgram, "objectColor"), 1, (float*)Entity->Color);
+	glUniform3fv(glGetUniformLocation(ShaderProgram, "objectColor"), 1, Color);
 
 	unsigned int ModelLoc = glGetUniformLocation(ShaderProgram, "model");
 
 	if (ModelLoc)
+		glUniformMatrix4fv(ModelLoc, 1, GL_FALSE, (float*)Transform);
+
+	ogt_bind_model_geometry(ModelInfo);
+
+	glUniform1i(glGetUniformLocation(ShaderProgram, "compactVertices"), ModelInfo->VertexLayout == VERTEX_LAYOUT_COMPACT);
+
+	if (ModelInfo->VertexLayout == VERTEX_LAYOUT_COMPACT)
 	{
-		mat4 Transform;
-		glm_mat4_identity(Transform);
-		glm_translate(Transform, Entity->Origin);
-		glm_rotate(Transform, glm_rad(Entity->Angles[0]), VEC3_RIGHT);
-		glm_rotate(Transform, glm_rad(Entity->Angles[1]), VEC3_UP);
-		glm_rotate(Transform, glm_rad(Entity->Angles[2]), VEC3_FORWARD);
+		vec3 Extents;
+		glm_vec3_sub(ModelInfo->Maxs, ModelInfo->Mins, Extents);
 
-		glUniformMatrix4fv(ModelLoc, 1, GL_FALSE, (float*)Transform);
+		glUniform3fv(glGetUniformLocation(ShaderProgram, "positionOffset"), 1, ModelInfo->Mins);
+		glUniform3fv(glGetUniformLocation(ShaderProgram, "positionScale"), 1, Extents);
 	}
 
-	glBindVertexArray(ModelInfo->VAO);
+	size_t IndexSize = ModelInfo->IndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+	unsigned int Level = select_model_lod(ModelInfo, Origin, Lod);
+	float ScreenSize = get_model_screen_size(ModelInfo, Origin);
 
 	if (ModelInfo->SubmeshCount > 0)
 	{
@@ -263,7 +691,7 @@ void ogt_render_entity_basic(Entity_t* Entity, float DeltaTime)
 			Mesh_t* Submesh = &ModelInfo->Submeshes[i];
 			Material_t* Material = Submesh->Material;
 
-			if (Material && Material->TextureID)
+			if (Material && Material->Texture && Material->Texture->State == TEXTURE_STATE_READY)
 			{
 				glUniform3fv(glGetUniformLocation(ShaderProgram, "MaterialAmbient"), 1, Material->AmbientColor);
 				glUniform3fv(glGetUniformLocation(ShaderProgram, "MaterialDiffuse"), 1, Material->DiffuseColor);
@@ -271,9 +699,12 @@ void ogt_render_entity_basic(Entity_t* Entity, float DeltaTime)
 				glUniform1f(glGetUniformLocation(ShaderProgram, "MaterialShininess"), Material->SpecularExponent);
 				glUniform1f(glGetUniformLocation(ShaderProgram, "uMaterialAlpha"), Material->Dissolve);
 
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, Material->TextureID);
-				glUniform1i(glGetUniformLocation(ShaderProgram, "useTexture"), 1);
+				ogt_request_texture_size(Material->Texture, ScreenSize);
+
+				// Materials sharing an array only change the layer between submeshes
+				ogt_bind_texture(Material->Texture);
+				glUniform1i(glGetUniformLocation(ShaderProgram, "useTexture"), Material->Texture->Array ? 2 : 1);
+				glUniform1f(glGetUniformLocation(ShaderProgram, "textureLayer"), (float)Material->Texture->Layer);
 			}
 			else
 			{
@@ -286,19 +717,24 @@ void ogt_render_entity_basic(Entity_t* Entity, float DeltaTime)
 				glUniform1i(glGetUniformLocation(ShaderProgram, "useTexture"), 0);
 			}
 
-			glDrawArrays(GL_TRIANGLES, (GLint)Submesh->Index, (GLsizei)Submesh->VertexCount);
+			// Only read when the layout has no per-vertex material color
+			glVertexAttrib3fv(3, Material ? Material->DiffuseColor : (float*)VEC3_ONE);
+
+			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)Submesh->Lods[Level].IndexCount, ModelInfo->IndexType, (void*)(ModelInfo->IndexOffset + Submesh->Lods[Level].FirstIndex * IndexSize), (GLint)ModelInfo->BaseVertex);
 		}
 	}
 	else
 	{
-		glUniform3fv(glGetUniformLocation(ShaderProgram, "MaterialAmbient"), 1, Entity->Color);
-		glUniform3fv(glGetUniformLocation(ShaderProgram, "MaterialDiffuse"), 1, Entity->Color);
+		glUniform3fv(glGetUniformLocation(ShaderProgram, "MaterialAmbient"), 1, Color);
+		glUniform3fv(glGetUniformLocation(ShaderProgram, "MaterialDiffuse"), 1, Color);
 		glUniform3fv(glGetUniformLocation(ShaderProgram, "MaterialSpecular"), 1, (float*)VEC3_ONE);
 		glUniform1f(glGetUniformLocation(ShaderProgram, "MaterialShininess"), 1.f);
 		glUniform1f(glGetUniformLocation(ShaderProgram, "uMaterialAlpha"), 1.f);
 		glUniform1i(glGetUniformLocation(ShaderProgram, "useTexture"), 0);
 
-		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)ModelInfo->VertexCount);
+		glVertexAttrib3fv(3, (float*)VEC3_ONE);
+
+		glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)ModelInfo->Lods[Level].IndexCount, ModelInfo->IndexType, (void*)(ModelInfo->IndexOffset + ModelInfo->Lods[Level].FirstIndex * IndexSize), (GLint)ModelInfo->BaseVertex);
 	}
 }
 
@@ -318,5 +754,66 @@ void ogt_set_entity_model(Entity_t* Entity, const char* Path)
 		return;
 	}
 
+	// Taken after the new reference so setting the same model again can't drop it to zero
+	ogt_release_model(Entity->ModelInfo);
+
 	Entity->ModelInfo = ModelInfo;
+	Entity->GeometryFitted = 0;
+}
+
+bool ogt_get_entity_bounds(Entity_t* Entity, vec3 Mins, vec3 Maxs)
+{
+	vec3 ModelMins, ModelMaxs;
+
+	if (!ogt_get_model_bounds(Entity->ModelInfo, ModelMins, ModelMaxs))
+		return 0;
+
+	// Same transform the model is rendered with, built fresh since origin and angles may have moved since the last frame
+	mat4 Transform;
+	ogt_build_entity_transform(ogt_get_entity_origin(Entity), ogt_get_entity_angles(Entity), Transform);
+
+	vec3 Box[2];
+	glm_vec3_copy(ModelMins, Box[0]);
+	glm_vec3_copy(ModelMaxs, Box[1]);
+
+	glm_aabb_transform(Box, Transform, Box);
+
+	glm_vec3_copy(Box[0], Mins);
+	glm_vec3_copy(Box[1], Maxs);
+
+	return 1;
+}
+
+bool ogt_fit_entity_box(Entity_t* Entity, dReal Mass)
+{
+	if (Entity->GeometryFitted)
+		return 1;
+
+	dGeomID Geometry = ogt_get_entity_geometry(Entity);
+	dBodyID Body = ogt_get_entity_body(Entity);
+
+	if (!ogt_fit_box_to_model(Body, Geometry, Entity->ModelInfo, Mass))
+		return 0;
+
+	return Entity->GeometryFitted = 1;
+}
+
+void ogt_print_entity_stats()
+{
+	EntityManager_t* Manager = GlobalVars->EntityManager;
+	unsigned int Capacity = Manager->BlockCount * ENTITY_BLOCK_SIZE;
+
+	// Free counts deleted slots plus the ones in allocated blocks that haven't been handed out yet
+	printf(
+		"Entities - Live: %u Free: %u (%u deleted) Peak: %u Slots: %u Slot size: %zu Class arena: %zu/%zu bytes\n",
+
+		Manager->EntityCount,
+		Capacity - Manager->EntityCount,
+		Manager->FreeCount,
+		Manager->PeakCount,
+		Capacity,
+		sizeof(Entity_t),
+		Manager->ClassArena.Used,
+		Manager->ClassArena.Reserved
+	);
 }
@@ -1,13 +1,25 @@
 #ifndef ogt_ents
 #define ogt_ents
 
+#include <stdint.h>
 #include <hashmap/map.h>
 #include <cglm/types.h>
 
 #include "models.h"
 #include "physics.h"
+#include "arena.h"
 
-#define MAX_ENTITIES 255
+#define ENTITY_INDEX_BITS 20
+#define ENTITY_GENERATION_BITS (32 - ENTITY_INDEX_BITS)
+#define MAX_ENTITIES (1u << ENTITY_INDEX_BITS)
+#define ENTITY_BLOCK_SIZE 1024 // Entities are allocated this many at a time and never move
+#define ENTITY_NULL_HANDLE 0 // Generations start at 1, so no live entity has this handle
+#define ENTITY_NO_INDEX UINT32_MAX
+#define ENTITY_COMPONENT_ALIGNMENT 32 // Enough for cglm's AVX mat4
+#define ENTITY_CACHE_LINE 64 // Entity slots are padded and aligned to this so neighbours never share a line
+#define ENTITY_THINK_BATCH_SIZE 256 // Live list entries per parallel think job
+
+typedef uint32_t EntityHandle_t; // Slot index in the low bits, slot generation above it
 
 typedef struct Entity_t Entity_t;
 typedef void (*CreationFn)(Entity_t* self);
@@ -30,45 +42,99 @@ typedef struct
 	const char* Name;
 
 	EntityCallbacks_t* Callbacks;
+
+	// Think only touches its own entity and components, so it can run on a worker next to other ones.
+	// It mustn't create or delete entities, change models or step physics
+	bool ParallelThink;
 } EntityClass_t;
 
 struct Entity_t
 {
-	bool Valid;
+	alignas(ENTITY_CACHE_LINE) bool Valid;
 	unsigned int Index;
+	EntityHandle_t Handle; // Changes every time the slot is reused, unlike the pointer
+	unsigned int NextFree; // Free list link while the slot is unused
+	unsigned int LiveIndex; // Position in the manager's live list while valid
 
 	EntityClass_t* ClassInfo;
 	ModelInfo_t* ModelInfo;
+	unsigned int Lod; // Kept between frames for hysteresis
 
-	vec3 Origin;
-	vec3 Angles;
-	vec3 Color;
-
-	dBodyID Body;
-	dGeomID Geometry;
+	bool GeometryFitted; // Box geometry has been sized to the model bounds
 };
 
 typedef struct
 {
-	unsigned int EntIndex;
-	Entity_t* Entities[MAX_ENTITIES];
+	unsigned int Start; // Live list range
+	unsigned int End;
+	float DeltaTime;
+} EntityThinkBatch_t;
+
+// Per entity data the per-frame passes stream through, one array each in live list order.
+// Deleting an entity moves the last one's data into its place, so don't hold on to pointers into these
+typedef struct
+{
+	vec4* Origins; // xyz, the w is padding so every entry is aligned
+	vec4* Angles; // Pitch, yaw, roll in degrees
+	vec4* Colors;
+	dBodyID* Bodies;
+	dGeomID* Geometries;
+	mat4* Transforms; // Model matrices built from origin and angles before rendering
+} EntityComponents_t;
+
+typedef struct
+{
+	unsigned int EntIndex; // Slots handed out so far, the high-water mark handles are checked against
+	unsigned int EntityCount; // Live ones
+	Entity_t** Live; // Packed, deletes move the last one into the hole, so order isn't kept
+	unsigned int LiveCapacity;
+	EntityComponents_t Components; // Same order and capacity as Live
+	Entity_t** Blocks; // ENTITY_BLOCK_SIZE slots each, grown on demand
+	unsigned int BlockCount;
 	hashmap* EntityClassMap;
 	hashmap* EntityModelMap;
+	Arena_t ClassArena; // Classes and their callbacks, they're never unregistered
+
+	EntityHandle_t* ThinkHandles; // Serial thinks to run this frame, same capacity as Live
+	EntityThinkBatch_t* ThinkBatches; // Reused every frame
+	unsigned int ThinkBatchCapacity;
+	bool ThinkingInParallel; // Creating and deleting are refused while parallel thinks run
+
+	unsigned int FreeCount; // Slots on the free list
+	unsigned int PeakCount; // Most live at once
 
-	unsigned int FreeEntIndices[MAX_ENTITIES];
-	unsigned int FreeIndexCount;
+	// Deleted slots are reused oldest first so a slot's generation wraps as late as possible
+	unsigned int FreeHead;
+	unsigned int FreeTail;
 } EntityManager_t;
 
 void ogt_init_entity_system();
 EntityCallbacks_t* ogt_init_entity_callbacks();
 EntityClass_t* ogt_register_entity_class(const char* Class, EntityCallbacks_t* Callbacks);
 EntityClass_t* ogt_find_entity_class(const char* Class);
-Entity_t* ogt_create_entity_ex(EntityClass_t* EntityClass);
+EntityHandle_t ogt_create_entity_handle(EntityClass_t* EntityClass); // ENTITY_NULL_HANDLE on failure
+void ogt_delete_entity_handle(EntityHandle_t Handle); // Stale handles are ignored
+Entity_t* ogt_get_entity(EntityHandle_t Handle); // NULL once the entity is deleted, even if its slot was reused
+bool ogt_is_entity_valid(EntityHandle_t Handle);
+Entity_t* ogt_create_entity_ex(EntityClass_t* EntityClass); // Pointer wrappers, keep the handle to hold on to an entity across frames
 Entity_t* ogt_create_entity(const char* Class);
 void ogt_delete_entity(Entity_t* Entity);
-void ogt_think_entities(float DeltaTime);
+float* ogt_get_entity_origin(Entity_t* Entity); // Component accessors, valid until the next entity is deleted
+float* ogt_get_entity_angles(Entity_t* Entity);
+float* ogt_get_entity_color(Entity_t* Entity);
+dBodyID ogt_get_entity_body(Entity_t* Entity);
+void ogt_set_entity_body(Entity_t* Entity, dBodyID Body);
+dGeomID ogt_get_entity_geometry(Entity_t* Entity);
+void ogt_set_entity_geometry(Entity_t* Entity, dGeomID Geometry);
+void ogt_think_entities(float DeltaTime); // Serial thinks in live order, then parallel ones spread over the job system
+void ogt_build_entity_transform(const float* Origin, const float* Angles, mat4 Transform);
+void ogt_update_entity_transforms(); // Rebuilds every Transforms entry, ogt_render_entities calls it
+void ogt_print_entity_stats();
 void ogt_render_entities(float DeltaTime);
-void ogt_render_entity_basic(Entity_t* Entity, float DeltaTime); // Renders VAO
+void ogt_render_entity_basic(Entity_t* Entity, float DeltaTime); // Draws the model from its geometry arena
+void ogt_draw_model(ModelInfo_t* ModelInfo, mat4 Transform, const float* Origin, const float* Color, unsigned int* Lod); // Lod is kept by the caller between frames for hysteresis
 void ogt_set_entity_model(Entity_t* Entity, const char* Path);
+bool ogt_get_entity_bounds(Entity_t* Entity, vec3 Mins, vec3 Maxs); // World space, fails until the model is ready
+bool ogt_fit_entity_box(Entity_t* Entity, dReal Mass); // Call until it succeeds, models load in the background
 
 #endif
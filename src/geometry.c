@@ -0,0 +1,260 @@
+#include "geometry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glad/glad.h>
+
+#include "globals.h"
+
+static bool reserve_free_ranges(GeometryHeap_t* Heap, size_t Count)
+{
+	if (Count <= Heap->FreeCapacity)
+		return 1;
+
+	size_t Capacity = Heap->FreeCapacity > 0 ? Heap->FreeCapacity * 2 : 16;
+	GeometryRange_t* Free = realloc(Heap->Free, Capacity * sizeof(GeometryRange_t));
+
+	if (!Free)
+		return 0;
+
+	Heap->Free = Free;
+	Heap->FreeCapacity = Capacity;
+
+	return 1;
+}
+
+static bool free_heap_range(GeometryHeap_t* Heap, size_t Offset, size_t Size)
+{
+	if (Size == 0)
+		return 1;
+
+	size_t Index = 0;
+
+	while (Index < Heap->FreeCount && Heap->Free[Index].Offset < Offset)
+		Index++;
+
+	bool MergePrevious = Index > 0 && Heap->Free[Index - 1].Offset + Heap->Free[Index - 1].Size == Offset;
+	bool MergeNext = Index < Heap->FreeCount && Offset + Size == Heap->Free[Index].Offset;
+
+	if (MergePrevious && MergeNext)
+	{
+		Heap->Free[Index - 1].Size += Size + Heap->Free[Index].Size;
+
+		memmove(&Heap->Free[Index], &Heap->Free[Index + 1], (Heap->FreeCount - Index - 1) * sizeof(GeometryRange_t));
+		Heap->FreeCount--;
+	}
+	else if (MergePrevious)
+		Heap->Free[Index - 1].Size += Size;
+	else if (MergeNext)
+	{
+		Heap->Free[Index].Offset = Offset;
+		Heap->Free[Index].Size += Size;
+	}
+	else
+	{
+		if (!reserve_free_ranges(Heap, Heap->FreeCount + 1))
+			return 0;
+
+		memmove(&Heap->Free[Index + 1], &Heap->Free[Index], (Heap->FreeCount - Index) * sizeof(GeometryRange_t));
+
+		Heap->Free[Index].Offset = Offset;
+		Heap->Free[Index].Size = Size;
+		Heap->FreeCount++;
+	}
+
+	return 1;
+}
+
+// Moves everything into a bigger buffer, the old name is deleted so the caller has to rebind
+static bool grow_heap(GeometryHeap_t* Heap, size_t Size, size_t InitialCapacity)
+{
+	// Whatever is already free at the end counts towards the request
+	size_t Tail = 0;
+
+	if (Heap->FreeCount > 0)
+	{
+		const GeometryRange_t* Last = &Heap->Free[Heap->FreeCount - 1];
+
+		if (Last->Offset + Last->Size == Heap->Capacity)
+			Tail = Last->Size;
+	}
+
+	size_t Capacity = Heap->Capacity > 0 ? Heap->Capacity * 2 : InitialCapacity;
+
+	while (Capacity - Heap->Capacity + Tail < Size)
+		Capacity *= 2;
+
+	// Merging the new space in can't fail after the buffer has been swapped
+	if (!reserve_free_ranges(Heap, Heap->FreeCount + 1))
+		return 0;
+
+	unsigned int Buffer;
+	glGenBuffers(1, &Buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, Capacity * Heap->UnitSize, NULL, GL_STATIC_DRAW);
+
+	if (Heap->Buffer)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, Heap->Buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, Heap->Capacity * Heap->UnitSize);
+		glDeleteBuffers(1, &Heap->Buffer);
+	}
+
+	free_heap_range(Heap, Heap->Capacity, Capacity - Heap->Capacity);
+
+	Heap->Buffer = Buffer;
+	Heap->Capacity = Capacity;
+
+	return 1;
+}
+
+static bool alloc_heap_range(GeometryHeap_t* Heap, size_t Size, size_t InitialCapacity, size_t* Offset, bool* Grew)
+{
+	for (;;)
+	{
+		for (size_t i = 0; i < Heap->FreeCount; ++i)
+		{
+			GeometryRange_t* Range = &Heap->Free[i];
+
+			if (Range->Size < Size)
+				continue;
+
+			*Offset = Range->Offset;
+
+			Range->Offset += Size;
+			Range->Size -= Size;
+
+			if (Range->Size == 0)
+			{
+				memmove(Range, Range + 1, (Heap->FreeCount - i - 1) * sizeof(GeometryRange_t));
+				Heap->FreeCount--;
+			}
+
+			return 1;
+		}
+
+		if (!grow_heap(Heap, Size, InitialCapacity))
+			return 0;
+
+		*Grew = 1;
+	}
+}
+
+static void bind_arena_buffers(GeometryArena_t* Arena)
+{
+	if (!Arena->VAO)
+		glGenVertexArrays(1, &Arena->VAO);
+
+	glBindVertexArray(Arena->VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, Arena->Vertices.Buffer);
+	setup_vertex_attributes(Arena->Layout);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Arena->Indices.Buffer);
+
+	GlobalVars->GeometryManager->BoundVAO = Arena->VAO;
+}
+
+static size_t get_index_bytes(const ModelInfo_t* ModelInfo, size_t IndexSize)
+{
+	size_t Bytes = ModelInfo->IndexCount * IndexSize;
+
+	return (Bytes + GEOMETRY_INDEX_ALIGNMENT - 1) & ~(GEOMETRY_INDEX_ALIGNMENT - 1);
+}
+
+void ogt_init_geometry()
+{
+	GlobalVars->GeometryManager = (GeometryManager_t*)calloc(1, sizeof(GeometryManager_t));
+
+	if (!GlobalVars->GeometryManager)
+	{
+		printf("Failed to allocate for geometry manager!\n");
+		return;
+	}
+
+	// GL objects are made on first use, there may not be a context yet
+	for (int i = 0; i < VERTEX_LAYOUT_COUNT; ++i)
+	{
+		GeometryArena_t* Arena = &GlobalVars->GeometryManager->Arenas[i];
+
+		Arena->Layout = (VertexLayout_t)i;
+		Arena->Vertices.UnitSize = get_vertex_size(Arena->Layout);
+		Arena->Indices.UnitSize = 1;
+	}
+}
+
+bool ogt_alloc_model_geometry(ModelInfo_t* ModelInfo, const void* VertexData, const void* IndexData, size_t IndexSize)
+{
+	GeometryArena_t* Arena = &GlobalVars->GeometryManager->Arenas[ModelInfo->VertexLayout];
+
+	size_t VertexSize = Arena->Vertices.UnitSize;
+	size_t BaseVertex, IndexOffset;
+	bool Grew = 0;
+
+	if (!alloc_heap_range(&Arena->Vertices, ModelInfo->VertexCount, GEOMETRY_INITIAL_VERTICES, &BaseVertex, &Grew))
+		return 0;
+
+	if (!alloc_heap_range(&Arena->Indices, get_index_bytes(ModelInfo, IndexSize), GEOMETRY_INITIAL_INDEX_BYTES, &IndexOffset, &Grew))
+	{
+		free_heap_range(&Arena->Vertices, BaseVertex, ModelInfo->VertexCount);
+
+		if (Grew)
+			bind_arena_buffers(Arena);
+
+		return 0;
+	}
+
+	if (Grew)
+		bind_arena_buffers(Arena);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, Arena->Vertices.Buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, BaseVertex * VertexSize, ModelInfo->VertexCount * VertexSize, VertexData);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, Arena->Indices.Buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, IndexOffset, ModelInfo->IndexCount * IndexSize, IndexData);
+
+	ModelInfo->HasGeometry = 1;
+	ModelInfo->BaseVertex = BaseVertex;
+	ModelInfo->IndexOffset = IndexOffset;
+
+	return 1;
+}
+
+void ogt_free_model_geometry(ModelInfo_t* ModelInfo)
+{
+	if (!ModelInfo->HasGeometry)
+		return;
+
+	GeometryArena_t* Arena = &GlobalVars->GeometryManager->Arenas[ModelInfo->VertexLayout];
+	size_t IndexSize = ModelInfo->IndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+
+	// Only fails when the free list can't grow, the space is lost but nothing else breaks.
+	// Both are always returned, one failing mustn't leak the other
+	bool VerticesFreed = free_heap_range(&Arena->Vertices, ModelInfo->BaseVertex, ModelInfo->VertexCount);
+	bool IndicesFreed = free_heap_range(&Arena->Indices, ModelInfo->IndexOffset, get_index_bytes(ModelInfo, IndexSize));
+
+	if (!VerticesFreed || !IndicesFreed)
+		printf("Failed to return geometry for '%s'\n", ModelInfo->ModelPath);
+
+	ModelInfo->HasGeometry = 0;
+	ModelInfo->BaseVertex = 0;
+	ModelInfo->IndexOffset = 0;
+}
+
+void ogt_bind_model_geometry(const ModelInfo_t* ModelInfo)
+{
+	GeometryManager_t* Manager = GlobalVars->GeometryManager;
+	unsigned int VAO = Manager->Arenas[ModelInfo->VertexLayout].VAO;
+
+	if (Manager->BoundVAO == VAO)
+		return;
+
+	glBindVertexArray(VAO);
+	Manager->BoundVAO = VAO;
+}
+
+void ogt_reset_geometry_binding()
+{
+	GlobalVars->GeometryManager->BoundVAO = 0;
+}
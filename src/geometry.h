@@ -0,0 +1,52 @@
+#ifndef ogt_geometry
+#define ogt_geometry
+
+#include <stddef.h>
+
+#include "models.h"
+
+#define GEOMETRY_INITIAL_VERTICES 65536 // Per layout, arenas double whenever they run out
+#define GEOMETRY_INITIAL_INDEX_BYTES (1024 * 1024)
+#define GEOMETRY_INDEX_ALIGNMENT sizeof(unsigned int) // Every model's indices start aligned whatever their type
+
+typedef struct
+{
+	size_t Offset;
+	size_t Size;
+} GeometryRange_t;
+
+// First fit free list over one GL buffer, sizes and offsets are in units of UnitSize bytes
+typedef struct
+{
+	unsigned int Buffer;
+	size_t UnitSize;
+	size_t Capacity;
+
+	GeometryRange_t* Free; // Sorted by offset, neighbours are always merged
+	size_t FreeCount;
+	size_t FreeCapacity;
+} GeometryHeap_t;
+
+// One VAO shared by every model of a layout, models draw with base vertex offsets into it
+typedef struct
+{
+	unsigned int VAO;
+	VertexLayout_t Layout;
+
+	GeometryHeap_t Vertices; // In vertices so offsets are base vertices
+	GeometryHeap_t Indices; // In bytes
+} GeometryArena_t;
+
+typedef struct
+{
+	GeometryArena_t Arenas[VERTEX_LAYOUT_COUNT];
+	unsigned int BoundVAO; // Saves rebinding between models of the same layout
+} GeometryManager_t;
+
+void ogt_init_geometry();
+bool ogt_alloc_model_geometry(ModelInfo_t* ModelInfo, const void* VertexData, const void* IndexData, size_t IndexSize); // Main thread only
+void ogt_free_model_geometry(ModelInfo_t* ModelInfo);
+void ogt_bind_model_geometry(const ModelInfo_t* ModelInfo);
+void ogt_reset_geometry_binding(); // Call after binding any VAO that isn't an arena's
+
+#endif
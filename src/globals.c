@@ -19,7 +19,19 @@ void ogt_init_globals()
 	GlobalVars->WindowHeight = 0;
 
 	GlobalVars->EntityManager = NULL;
+	GlobalVars->EcsWorld = NULL;
+	GlobalVars->PhysicsManager = NULL;
+	GlobalVars->JobSystem = NULL;
+	GlobalVars->ModelLoader = NULL;
+	GlobalVars->TextureCache = NULL;
+	GlobalVars->GeometryManager = NULL;
+	GlobalVars->CurrentView = NULL;
 
+	ogt_init_jobs();
+	ogt_init_texture_cache();
+	ogt_init_model_loader();
+	ogt_init_geometry();
 	ogt_init_entity_system();
+	ogt_init_ecs();
 	ogt_init_physics();
 }
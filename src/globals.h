@@ -3,6 +3,10 @@
 
 #include "ents.h"
 #include "physics.h"
+#include "jobs.h"
+#include "render.h"
+#include "geometry.h"
+#include "ecs.h"
 
 #define VEC3_ONE ((vec3){ 1.f, 1.f, 1.f })
 #define VEC3_FORWARD ((vec3){ 1.f, 0.f, 0.f })
@@ -15,7 +19,13 @@ typedef struct
 	int WindowHeight;
 
 	EntityManager_t* EntityManager;
+	EcsWorld_t* EcsWorld;
 	PhysicsWorld_t* PhysicsManager;
+	JobSystem_t* JobSystem;
+	ModelLoader_t* ModelLoader;
+	TextureCache_t* TextureCache;
+	GeometryManager_t* GeometryManager;
+	RenderView_t* CurrentView; // Set while a view is being rendered
 } GlobalVars_t;
 
 extern GlobalVars_t* GlobalVars;
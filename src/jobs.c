@@ -0,0 +1,382 @@
+#include "jobs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "globals.h"
+#include "util.h"
+
+static _Thread_local JobQueue_t* WorkerQueue = NULL; // Set on worker threads, everyone else shares the last queue
+
+static unsigned int get_own_queue(JobSystem_t* Jobs)
+{
+	return WorkerQueue ? (unsigned int)(WorkerQueue - Jobs->Queues) : Jobs->QueueCount - 1;
+}
+
+static bool init_job_queue(JobQueue_t* Queue)
+{
+	init_mutex(&Queue->Lock);
+
+	Queue->Jobs = malloc(JOB_QUEUE_INITIAL_CAPACITY * sizeof(Job_t));
+	Queue->Capacity = Queue->Jobs ? JOB_QUEUE_INITIAL_CAPACITY : 0;
+	Queue->Head = 0;
+	Queue->Count = 0;
+
+	return Queue->Jobs != NULL;
+}
+
+static bool push_job(JobQueue_t* Queue, const Job_t* Job)
+{
+	lock_mutex(&Queue->Lock);
+
+	if (Queue->Count == Queue->Capacity)
+	{
+		size_t Capacity = Queue->Capacity * 2;
+		Job_t* Jobs = malloc(Capacity * sizeof(Job_t));
+
+		if (!Jobs)
+		{
+			unlock_mutex(&Queue->Lock);
+			return 0;
+		}
+
+		for (size_t i = 0; i < Queue->Count; ++i)
+			Jobs[i] = Queue->Jobs[(Queue->Head + i) % Queue->Capacity];
+
+		free(Queue->Jobs);
+
+		Queue->Jobs = Jobs;
+		Queue->Capacity = Capacity;
+		Queue->Head = 0;
+	}
+
+	Queue->Jobs[(Queue->Head + Queue->Count) % Queue->Capacity] = *Job;
+	Queue->Count++;
+
+	unlock_mutex(&Queue->Lock);
+
+	return 1;
+}
+
+// Null counters match anything, waiters pass theirs so they only help with what they're waiting on
+static bool job_matches(const Job_t* Job, const JobCounter_t* Counter)
+{
+	return !Counter || Job->Counter == Counter;
+}
+
+// Offset is from the head, closing the gap is free at either end of the ring
+static void remove_job(JobQueue_t* Queue, size_t Offset, Job_t* Job)
+{
+	*Job = Queue->Jobs[(Queue->Head + Offset) % Queue->Capacity];
+
+	if (Offset == 0)
+		Queue->Head = (Queue->Head + 1) % Queue->Capacity;
+	else
+	{
+		for (size_t i = Offset + 1; i < Queue->Count; ++i)
+			Queue->Jobs[(Queue->Head + i - 1) % Queue->Capacity] = Queue->Jobs[(Queue->Head + i) % Queue->Capacity];
+	}
+
+	Queue->Count--;
+}
+
+// Newest first, it's the one most likely to still be in cache
+static bool pop_job(JobQueue_t* Queue, const JobCounter_t* Counter, Job_t* Job)
+{
+	lock_mutex(&Queue->Lock);
+
+	bool Found = 0;
+
+	for (size_t i = Queue->Count; !Found && i-- > 0;)
+	{
+		if ((Found = job_matches(&Queue->Jobs[(Queue->Head + i) % Queue->Capacity], Counter)))
+			remove_job(Queue, i, Job);
+	}
+
+	unlock_mutex(&Queue->Lock);
+
+	return Found;
+}
+
+// Oldest first, leaving the owner the work it queued last
+static bool steal_job(JobQueue_t* Queue, const JobCounter_t* Counter, Job_t* Job)
+{
+	lock_mutex(&Queue->Lock);
+
+	bool Found = 0;
+
+	for (size_t i = 0; !Found && i < Queue->Count; ++i)
+	{
+		if ((Found = job_matches(&Queue->Jobs[(Queue->Head + i) % Queue->Capacity], Counter)))
+			remove_job(Queue, i, Job);
+	}
+
+	unlock_mutex(&Queue->Lock);
+
+	return Found;
+}
+
+static bool has_job(JobSystem_t* Jobs, const JobCounter_t* Counter)
+{
+	bool Found = 0;
+
+	for (unsigned int i = 0; !Found && i < Jobs->QueueCount; ++i)
+	{
+		JobQueue_t* Queue = &Jobs->Queues[i];
+
+		lock_mutex(&Queue->Lock);
+
+		for (size_t j = 0; !Found && j < Queue->Count; ++j)
+			Found = job_matches(&Queue->Jobs[(Queue->Head + j) % Queue->Capacity], Counter);
+
+		unlock_mutex(&Queue->Lock);
+	}
+
+	return Found;
+}
+
+static bool take_job(JobSystem_t* Jobs, const JobCounter_t* Counter, Job_t* Job)
+{
+	if (atomic_load(&Jobs->Queued) == 0)
+		return 0;
+
+	unsigned int Own = get_own_queue(Jobs);
+	bool Found = pop_job(&Jobs->Queues[Own], Counter, Job);
+
+	// Walk the others starting from the next one along, so thieves spread out instead of all hitting queue 0
+	for (unsigned int i = 1; !Found && i < Jobs->QueueCount; ++i)
+	{
+		Found = steal_job(&Jobs->Queues[(Own + i) % Jobs->QueueCount], Counter, Job);
+
+		if (Found)
+			atomic_fetch_add_explicit(&Jobs->Steals, 1, memory_order_relaxed);
+	}
+
+	if (Found)
+		atomic_fetch_sub(&Jobs->Queued, 1);
+
+	return Found;
+}
+
+static void finish_job(JobSystem_t* Jobs, const Job_t* Job)
+{
+	if (!Job->Counter)
+		return;
+
+	if (atomic_fetch_sub(&Job->Counter->Pending, 1) == 1)
+	{
+		lock_mutex(&Jobs->Lock);
+		broadcast_condition(&Jobs->WorkDone);
+		unlock_mutex(&Jobs->Lock);
+	}
+}
+
+static void worker_main(void* Data)
+{
+	JobSystem_t* Jobs = GlobalVars->JobSystem;
+
+	WorkerQueue = (JobQueue_t*)Data;
+
+	while (!atomic_load(&Jobs->Stopping))
+	{
+		Job_t Job;
+
+		if (take_job(Jobs, NULL, &Job))
+		{
+			Job.Function(Job.Data);
+			finish_job(Jobs, &Job);
+
+			continue;
+		}
+
+		// Submitting bumps Queued before checking Sleeping, so one of the two sides always sees the other
+		lock_mutex(&Jobs->Lock);
+		atomic_fetch_add(&Jobs->Sleeping, 1);
+
+		while (atomic_load(&Jobs->Queued) == 0 && !atomic_load(&Jobs->Stopping))
+			wait_condition(&Jobs->WorkAvailable, &Jobs->Lock);
+
+		atomic_fetch_sub(&Jobs->Sleeping, 1);
+		unlock_mutex(&Jobs->Lock);
+	}
+}
+
+void ogt_init_jobs()
+{
+	JobSystem_t* Jobs = (JobSystem_t*)malloc(sizeof(JobSystem_t));
+
+	if (!Jobs)
+	{
+		printf("Failed to allocate for job system!\n");
+		return;
+	}
+
+	init_mutex(&Jobs->Lock);
+	init_condition(&Jobs->WorkAvailable);
+	init_condition(&Jobs->WorkDone);
+
+	atomic_init(&Jobs->Queued, 0);
+	atomic_init(&Jobs->Sleeping, 0);
+	atomic_init(&Jobs->Waiting, 0);
+	atomic_init(&Jobs->Steals, 0);
+	atomic_init(&Jobs->Stopping, 0);
+
+	// The thread waiting on a job helps run it, so leave a core for it
+	unsigned int WorkerCount = get_cpu_count() - 1;
+
+	Jobs->QueueCount = WorkerCount + 1;
+	Jobs->Queues = alloc_aligned(alignof(JobQueue_t), Jobs->QueueCount * sizeof(JobQueue_t));
+	Jobs->Workers = WorkerCount > 0 ? malloc(WorkerCount * sizeof(Thread_t)) : NULL;
+	Jobs->WorkerCount = 0;
+
+	GlobalVars->JobSystem = Jobs;
+
+	bool Queued = Jobs->Queues != NULL;
+
+	for (unsigned int i = 0; Queued && i < Jobs->QueueCount; ++i)
+		Queued = init_job_queue(&Jobs->Queues[i]);
+
+	if (!Queued)
+	{
+		printf("Failed to allocate job queues!\n");
+
+		Jobs->QueueCount = 0;
+		return;
+	}
+
+	for (unsigned int i = 0; Jobs->Workers && i < WorkerCount; ++i)
+	{
+		if (!create_thread(&Jobs->Workers[Jobs->WorkerCount], worker_main, &Jobs->Queues[i]))
+		{
+			printf("Failed to create job worker %d\n", i);
+			break;
+		}
+
+		Jobs->WorkerCount++;
+	}
+}
+
+void ogt_shutdown_jobs()
+{
+	JobSystem_t* Jobs = GlobalVars->JobSystem;
+
+	if (!Jobs)
+		return;
+
+	// Set under the lock so a worker can't check it and then go to sleep after the broadcast
+	lock_mutex(&Jobs->Lock);
+	atomic_store(&Jobs->Stopping, 1);
+	broadcast_condition(&Jobs->WorkAvailable);
+	unlock_mutex(&Jobs->Lock);
+
+	for (unsigned int i = 0; i < Jobs->WorkerCount; ++i)
+		join_thread(Jobs->Workers[i]);
+
+	for (unsigned int i = 0; i < Jobs->QueueCount; ++i)
+	{
+		free(Jobs->Queues[i].Jobs);
+		destroy_mutex(&Jobs->Queues[i].Lock);
+	}
+
+	destroy_condition(&Jobs->WorkDone);
+	destroy_condition(&Jobs->WorkAvailable);
+	destroy_mutex(&Jobs->Lock);
+
+	free_aligned(Jobs->Queues);
+	free(Jobs->Workers);
+	free(Jobs);
+
+	GlobalVars->JobSystem = NULL;
+}
+
+unsigned int ogt_get_worker_count()
+{
+	return GlobalVars->JobSystem ? GlobalVars->JobSystem->WorkerCount : 0;
+}
+
+void ogt_submit_job(JobFn Function, void* Data, JobCounter_t* Counter)
+{
+	JobSystem_t* Jobs = GlobalVars->JobSystem;
+	Job_t Job = { Function, Data, Counter };
+
+	if (Counter)
+		atomic_fetch_add(&Counter->Pending, 1);
+
+	if (Jobs && Jobs->WorkerCount > 0)
+	{
+		// Counted first so a worker can't take it and bring Queued below zero
+		atomic_fetch_add(&Jobs->Queued, 1);
+
+		if (push_job(&Jobs->Queues[get_own_queue(Jobs)], &Job))
+		{
+			bool Sleeping = atomic_load(&Jobs->Sleeping) > 0;
+			bool Waiting = Counter && atomic_load(&Jobs->Waiting) > 0;
+
+			if (Sleeping || Waiting)
+			{
+				lock_mutex(&Jobs->Lock);
+
+				if (Sleeping)
+					signal_condition(&Jobs->WorkAvailable);
+
+				if (Waiting)
+					broadcast_condition(&Jobs->WorkDone); // Whoever's waiting on this counter can help with it
+
+				unlock_mutex(&Jobs->Lock);
+			}
+
+			return;
+		}
+
+		atomic_fetch_sub(&Jobs->Queued, 1);
+	}
+
+	// No workers or no room, just run it here
+	Function(Data);
+
+	if (Counter)
+		atomic_fetch_sub(&Counter->Pending, 1);
+}
+
+void ogt_wait_for_jobs(JobCounter_t* Counter)
+{
+	JobSystem_t* Jobs = GlobalVars->JobSystem;
+
+	if (!Jobs)
+		return;
+
+	while (atomic_load(&Counter->Pending) > 0)
+	{
+		Job_t Job;
+
+		// Only our own jobs, picking up an unrelated model load here could stall a frame for a long time
+		if (take_job(Jobs, Counter, &Job))
+		{
+			Job.Function(Job.Data);
+			finish_job(Jobs, &Job);
+
+			continue;
+		}
+
+		// Nothing of ours left to help with, the rest is running elsewhere.
+		// Submitting checks Waiting after queueing, so a job of ours queued after the check still wakes us
+		lock_mutex(&Jobs->Lock);
+		atomic_fetch_add(&Jobs->Waiting, 1);
+
+		if (atomic_load(&Counter->Pending) > 0 && !has_job(Jobs, Counter))
+			wait_condition(&Jobs->WorkDone, &Jobs->Lock);
+
+		atomic_fetch_sub(&Jobs->Waiting, 1);
+		unlock_mutex(&Jobs->Lock);
+	}
+}
+
+void ogt_print_job_stats()
+{
+	JobSystem_t* Jobs = GlobalVars->JobSystem;
+
+	if (!Jobs)
+		return;
+
+	printf("Jobs - Workers: %u Steals: %zu\n", Jobs->WorkerCount, atomic_load(&Jobs->Steals));
+}
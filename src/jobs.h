@@ -0,0 +1,63 @@
+#ifndef ogt_jobs
+#define ogt_jobs
+
+#include <stddef.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "threads.h"
+
+#define JOB_QUEUE_INITIAL_CAPACITY 64
+#define JOB_CACHE_LINE 64 // Queues are padded to this so workers don't fight over each other's lines
+
+typedef void (*JobFn)(void* Data);
+
+typedef struct
+{
+	atomic_size_t Pending;
+} JobCounter_t;
+
+typedef struct
+{
+	JobFn Function;
+	void* Data;
+	JobCounter_t* Counter;
+} Job_t;
+
+// The owning thread pushes and pops at the back, other threads steal from the front
+typedef struct
+{
+	alignas(JOB_CACHE_LINE) Mutex_t Lock;
+	Job_t* Jobs; // Ring buffer
+	size_t Capacity;
+	size_t Head;
+	size_t Count;
+} JobQueue_t;
+
+typedef struct
+{
+	JobQueue_t* Queues; // One per worker, then a shared one at the end for every other thread
+	unsigned int QueueCount;
+	atomic_size_t Queued; // Across all queues, can briefly run ahead of what's actually in them
+
+	Mutex_t Lock; // Only for sleeping and waking
+	Condition_t WorkAvailable;
+	Condition_t WorkDone;
+	atomic_uint Sleeping; // Workers waiting on WorkAvailable, submitting skips the wake up when there are none
+	atomic_uint Waiting; // Threads in ogt_wait_for_jobs sleeping on WorkDone
+
+	Thread_t* Workers;
+	unsigned int WorkerCount;
+	atomic_bool Stopping; // Workers finish the job they're on and leave, whatever's still queued is dropped
+
+	atomic_size_t Steals;
+} JobSystem_t;
+
+void ogt_init_jobs();
+void ogt_shutdown_jobs();
+unsigned int ogt_get_worker_count();
+void ogt_submit_job(JobFn Function, void* Data, JobCounter_t* Counter);
+void ogt_wait_for_jobs(JobCounter_t* Counter); // Runs its own queued jobs on the calling thread while waiting, never anyone else's
+void ogt_print_job_stats();
+
+#endif
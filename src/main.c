@@ -12,6 +12,10 @@
 #include "entfactory.h"
 #include "render.h"
 #include "physics.h"
+#include "bench.h"
+#include "texturebake.h"
+#include "entities/monkey.h"
+#include "entities/world.h"
 
 float DeltaTime = 0.0f;
 float LastFrame = 0.0f;
@@ -103,8 +107,41 @@ void OnMouseMove(GLFWwindow* Window, double MouseX, double MouseY)
 	angles_to_vec3(Yaw, Pitch, View.Forward, Right, Up);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	// Baking is pure CPU work, no window needed
+	if (argc > 1 && strcmp(argv[1], "--bake") == 0)
+	{
+		MipOptions_t Options;
+		get_default_mip_options(&Options);
+		init_mip_tables();
+
+		bool Compress = 0;
+		int First = 2;
+
+		for (; First < argc && strncmp(argv[First], "--", 2) == 0; ++First)
+		{
+			if (strcmp(argv[First], "--compress") == 0)
+				Compress = 1;
+			else if (strcmp(argv[First], "--box") == 0)
+				Options.Filter = MIP_FILTER_BOX;
+			else if (strcmp(argv[First], "--linear") == 0)
+				Options.SRGB = 0;
+			else if (strcmp(argv[First], "--coverage") == 0)
+				Options.PreserveCoverage = 1;
+		}
+
+		bool Baked = First < argc;
+
+		if (!Baked)
+			printf("Usage: %s --bake [--compress] [--box] [--linear] [--coverage] <image>...\n", argv[0]);
+
+		for (int i = First; i < argc; ++i)
+			Baked = bake_texture(argv[i], Compress, &Options) && Baked;
+
+		return Baked ? 0 : -1;
+	}
+
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -133,6 +170,16 @@ int main()
 	GlobalVars->WindowHeight = 600;
 
 	glViewport(0, 0, GlobalVars->WindowWidth, GlobalVars->WindowHeight);
+
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+	{
+		bool Passed = ogt_run_benchmarks(argc - 2, argv + 2);
+		ogt_shutdown_jobs();
+		glfwTerminate();
+
+		return Passed ? 0 : -1;
+	}
+
 	glfwSetFramebufferSizeCallback(Window, OnSizeChange);
 	glEnable(GL_DEPTH_TEST);
 
@@ -170,7 +217,9 @@ int main()
 		return -1;
 	}
 
-	Entity_t* World = ogt_create_entity("world");
+	// Static geometry is a natural fit for the ECS, the second monkey shows both paths side by side
+	ogt_spawn_ecs_world();
+
 	EntityClass_t* Monkey = ogt_find_entity_class("monkey");
 
 	if (Monkey)
@@ -183,13 +232,18 @@ int main()
 		//ogt_set_entity_model(MokeB, "../src/models/monkey.obj");
 		// ogt_set_entity_model(Gooba, "../src/models/spongekey.obj");
 
-		dBodySetPosition(MokeA->Body, 0, 10, 0);
-		dBodySetAngularVel(MokeA->Body, 0.5, 0.0, 0.0);
+		dBodySetPosition(ogt_get_entity_body(MokeA), 0, 10, 0);
+		dBodySetAngularVel(ogt_get_entity_body(MokeA), 0.5, 0.0, 0.0);
 
-		//dBodySetPosition(MokeB->Body, 0, 13, -5);
-		//dBodySetAngularVel(MokeB->Body, 0.5, 0.0, 0.0);
+		//dBodySetPosition(ogt_get_entity_body(MokeB), 0, 13, -5);
+		//dBodySetAngularVel(ogt_get_entity_body(MokeB), 0.5, 0.0, 0.0);
 	}
 
+	EcsEntity_t EcsMoke = ogt_spawn_ecs_monkey((vec3){ 0.f, 13.f, -5.f });
+
+	if (EcsMoke != ECS_NULL_ENTITY)
+		dBodySetAngularVel(((EcsBody_t*)ogt_ecs_get(EcsMoke, ECS_BODY))->Body, 0.5, 0.0, 0.0);
+
 	ogt_setup_view(&View, (vec3){ 0.f, 10.f, 10.f }, (vec3){ 0, 0, -1.f }, 45.f, .1f, 100.f);
 
 	while (!glfwWindowShouldClose(Window))
@@ -200,7 +254,12 @@ int main()
 
 		ProcessInput(Window);
 
+		ogt_process_model_uploads(MODEL_UPLOAD_BUDGET);
+		ogt_evict_models();
+		ogt_stream_textures(TEXTURE_STREAM_UPLOAD_BUDGET);
+
 		ogt_think_entities(DeltaTime);
+		ogt_ecs_update();
 
 		ogt_simulate_physics(DeltaTime);
 
@@ -211,6 +270,14 @@ int main()
 		glfwPollEvents();
 	}
 
+	// Workers can still be writing a model cache or decoding textures, nothing below is safe until they're gone
+	ogt_print_job_stats();
+	ogt_shutdown_jobs();
+
+	ogt_print_texture_stats();
+	ogt_print_entity_stats();
+	ogt_print_ecs_stats();
+
 	glfwTerminate();
 
 	return 0;
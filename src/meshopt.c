@@ -0,0 +1,393 @@
+#include "meshopt.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <cglm/cglm.h>
+
+typedef struct
+{
+	size_t Start; // Triangle
+	size_t Count;
+	float Sort;
+} MeshCluster_t;
+
+static int get_next_vertex(const unsigned int* Candidates, size_t CandidateCount, const unsigned int* Live, const size_t* Times, size_t Time, size_t CacheSize)
+{
+	int Best = -1;
+	long BestPriority = -1;
+
+	for (size_t i = 0; i < CandidateCount; ++i)
+	{
+		unsigned int Vertex = Candidates[i];
+
+		if (Live[Vertex] == 0)
+			continue;
+
+		// Prefer vertices that will still be cached once their remaining triangles are emitted
+		long Priority = 0;
+
+		if (Time - Times[Vertex] + 2 * Live[Vertex] <= CacheSize)
+			Priority = (long)(Time - Times[Vertex]);
+
+		if (Priority > BestPriority)
+		{
+			Best = (int)Vertex;
+			BestPriority = Priority;
+		}
+	}
+
+	return Best;
+}
+
+size_t optimize_vertex_cache(unsigned int* Indices, size_t IndexCount, size_t VertexCount, size_t CacheSize, size_t* Clusters)
+{
+	size_t TriangleCount = IndexCount / 3;
+
+	if (TriangleCount == 0)
+		return 0;
+
+	unsigned int* Offsets = calloc(VertexCount + 1, sizeof(unsigned int));
+	unsigned int* Live = calloc(VertexCount, sizeof(unsigned int));
+	unsigned int* Adjacency = malloc(TriangleCount * 3 * sizeof(unsigned int));
+	size_t* Times = calloc(VertexCount, sizeof(size_t));
+	unsigned int* DeadEnds = malloc(TriangleCount * 3 * sizeof(unsigned int));
+	unsigned int* Candidates = malloc(TriangleCount * 3 * sizeof(unsigned int));
+	bool* Emitted = calloc(TriangleCount, sizeof(bool));
+	unsigned int* Output = malloc(TriangleCount * 3 * sizeof(unsigned int));
+
+	if (!Offsets || !Live || !Adjacency || !Times || !DeadEnds || !Candidates || !Emitted || !Output)
+	{
+		free(Offsets);
+		free(Live);
+		free(Adjacency);
+		free(Times);
+		free(DeadEnds);
+		free(Candidates);
+		free(Emitted);
+		free(Output);
+
+		Clusters[0] = 0;
+
+		return 1;
+	}
+
+	for (size_t i = 0; i < TriangleCount * 3; ++i)
+		Live[Indices[i]]++;
+
+	for (size_t i = 0; i < VertexCount; ++i)
+		Offsets[i + 1] = Offsets[i] + Live[i];
+
+	// Offsets[v] is used as a fill cursor, then shifted back
+	for (size_t Triangle = 0; Triangle < TriangleCount; ++Triangle)
+		for (int Vert = 0; Vert < 3; ++Vert)
+			Adjacency[Offsets[Indices[(Triangle * 3) + Vert]]++] = (unsigned int)Triangle;
+
+	for (size_t i = VertexCount; i > 0; --i)
+		Offsets[i] = Offsets[i - 1];
+
+	Offsets[0] = 0;
+
+	size_t Time = CacheSize + 1;
+	size_t DeadEndCount = 0;
+	size_t OutputCount = 0;
+	size_t ClusterCount = 0;
+	size_t Cursor = 0;
+	int Fan = (int)Indices[0];
+
+	Clusters[ClusterCount++] = 0;
+
+	while (Fan >= 0)
+	{
+		size_t CandidateCount = 0;
+
+		for (unsigned int a = Offsets[Fan]; a < Offsets[Fan + 1]; ++a)
+		{
+			unsigned int Triangle = Adjacency[a];
+
+			if (Emitted[Triangle])
+				continue;
+
+			for (int Vert = 0; Vert < 3; ++Vert)
+			{
+				unsigned int Vertex = Indices[(Triangle * 3) + Vert];
+
+				Output[OutputCount++] = Vertex;
+				DeadEnds[DeadEndCount++] = Vertex;
+				Candidates[CandidateCount++] = Vertex;
+
+				Live[Vertex]--;
+
+				if (Time - Times[Vertex] > CacheSize)
+					Times[Vertex] = Time++;
+			}
+
+			Emitted[Triangle] = 1;
+		}
+
+		Fan = get_next_vertex(Candidates, CandidateCount, Live, Times, Time, CacheSize);
+
+		if (Fan >= 0)
+			continue;
+
+		// Dead end, back up through recently used vertices before scanning for a fresh one
+		while (DeadEndCount > 0 && Fan < 0)
+		{
+			unsigned int Vertex = DeadEnds[--DeadEndCount];
+
+			if (Live[Vertex] > 0)
+				Fan = (int)Vertex;
+		}
+
+		while (Fan < 0 && Cursor < VertexCount)
+		{
+			if (Live[Cursor] > 0)
+				Fan = (int)Cursor;
+
+			Cursor++;
+		}
+
+		// Jumping away from the fan is where the cache gets flushed, so it's a safe place to cut a cluster
+		if (Fan >= 0 && OutputCount / 3 > Clusters[ClusterCount - 1])
+			Clusters[ClusterCount++] = OutputCount / 3;
+	}
+
+	memcpy(Indices, Output, OutputCount * sizeof(unsigned int));
+
+	free(Offsets);
+	free(Live);
+	free(Adjacency);
+	free(Times);
+	free(DeadEnds);
+	free(Candidates);
+	free(Emitted);
+	free(Output);
+
+	return ClusterCount;
+}
+
+static int compare_clusters(const void* A, const void* B)
+{
+	const MeshCluster_t* ClusterA = (const MeshCluster_t*)A;
+	const MeshCluster_t* ClusterB = (const MeshCluster_t*)B;
+
+	if (ClusterA->Sort != ClusterB->Sort)
+		return ClusterA->Sort > ClusterB->Sort ? -1 : 1;
+
+	return ClusterA->Start < ClusterB->Start ? -1 : (ClusterA->Start > ClusterB->Start);
+}
+
+void optimize_overdraw(const float* Vertices, size_t Stride, unsigned int* Indices, size_t IndexCount, const size_t* Clusters, size_t ClusterCount)
+{
+	size_t TriangleCount = IndexCount / 3;
+
+	if (ClusterCount < 2)
+		return;
+
+	MeshCluster_t* Sorted = malloc(ClusterCount * sizeof(MeshCluster_t));
+	vec3* Centroids = malloc(ClusterCount * sizeof(vec3));
+	vec3* Normals = malloc(ClusterCount * sizeof(vec3));
+	unsigned int* Output = malloc(IndexCount * sizeof(unsigned int));
+
+	if (!Sorted || !Centroids || !Normals || !Output)
+	{
+		free(Sorted);
+		free(Centroids);
+		free(Normals);
+		free(Output);
+
+		return;
+	}
+
+	vec3 MeshCentroid = { 0.f, 0.f, 0.f };
+	float MeshArea = 0.f;
+
+	for (size_t c = 0; c < ClusterCount; ++c)
+	{
+		size_t End = c + 1 < ClusterCount ? Clusters[c + 1] : TriangleCount;
+		float ClusterArea = 0.f;
+
+		Sorted[c].Start = Clusters[c];
+		Sorted[c].Count = End - Clusters[c];
+
+		glm_vec3_zero(Centroids[c]);
+		glm_vec3_zero(Normals[c]);
+
+		for (size_t Triangle = Clusters[c]; Triangle < End; ++Triangle)
+		{
+			const float* A = &Vertices[Indices[(Triangle * 3) + 0] * Stride];
+			const float* B = &Vertices[Indices[(Triangle * 3) + 1] * Stride];
+			const float* C = &Vertices[Indices[(Triangle * 3) + 2] * Stride];
+
+			vec3 AB, AC, Normal, Center;
+			glm_vec3_sub((float*)B, (float*)A, AB);
+			glm_vec3_sub((float*)C, (float*)A, AC);
+			glm_vec3_cross(AB, AC, Normal);
+
+			// Twice the area, which cancels out in the weighting
+			float Area = glm_vec3_norm(Normal);
+
+			glm_vec3_add((float*)A, (float*)B, Center);
+			glm_vec3_add(Center, (float*)C, Center);
+			glm_vec3_scale(Center, Area / 3.f, Center);
+
+			glm_vec3_add(Centroids[c], Center, Centroids[c]);
+			glm_vec3_add(Normals[c], Normal, Normals[c]);
+
+			ClusterArea += Area;
+		}
+
+		glm_vec3_add(MeshCentroid, Centroids[c], MeshCentroid);
+		MeshArea += ClusterArea;
+
+		if (ClusterArea > 0.f)
+			glm_vec3_divs(Centroids[c], ClusterArea, Centroids[c]);
+
+		glm_vec3_normalize(Normals[c]);
+	}
+
+	if (MeshArea > 0.f)
+		glm_vec3_divs(MeshCentroid, MeshArea, MeshCentroid);
+
+	// Clusters facing away from the middle of the mesh are likely to occlude the rest, so they go first
+	for (size_t c = 0; c < ClusterCount; ++c)
+	{
+		vec3 Offset;
+		glm_vec3_sub(Centroids[c], MeshCentroid, Offset);
+
+		Sorted[c].Sort = glm_vec3_dot(Offset, Normals[c]);
+	}
+
+	qsort(Sorted, ClusterCount, sizeof(MeshCluster_t), compare_clusters);
+
+	size_t OutputCount = 0;
+
+	for (size_t c = 0; c < ClusterCount; ++c)
+	{
+		memcpy(&Output[OutputCount], &Indices[Sorted[c].Start * 3], Sorted[c].Count * 3 * sizeof(unsigned int));
+		OutputCount += Sorted[c].Count * 3;
+	}
+
+	memcpy(Indices, Output, IndexCount * sizeof(unsigned int));
+
+	free(Sorted);
+	free(Centroids);
+	free(Normals);
+	free(Output);
+}
+
+void optimize_mesh(const float* Vertices, size_t Stride, size_t VertexCount, unsigned int* Indices, size_t IndexCount)
+{
+	size_t TriangleCount = IndexCount / 3;
+
+	if (TriangleCount == 0)
+		return;
+
+	size_t* Clusters = malloc(TriangleCount * sizeof(size_t));
+	unsigned int* CacheOrder = malloc(IndexCount * sizeof(unsigned int));
+
+	if (!Clusters || !CacheOrder)
+	{
+		free(Clusters);
+		free(CacheOrder);
+
+		return;
+	}
+
+	size_t ClusterCount = optimize_vertex_cache(Indices, IndexCount, VertexCount, MESHOPT_CACHE_SIZE, Clusters);
+	memcpy(CacheOrder, Indices, IndexCount * sizeof(unsigned int));
+
+	optimize_overdraw(Vertices, Stride, Indices, IndexCount, Clusters, ClusterCount);
+
+	float CacheACMR, OverdrawACMR, ATVR;
+	analyze_vertex_cache(CacheOrder, IndexCount, VertexCount, MESHOPT_CACHE_SIZE, &CacheACMR, &ATVR);
+	analyze_vertex_cache(Indices, IndexCount, VertexCount, MESHOPT_CACHE_SIZE, &OverdrawACMR, &ATVR);
+
+	if (OverdrawACMR > CacheACMR * MESHOPT_OVERDRAW_THRESHOLD)
+		memcpy(Indices, CacheOrder, IndexCount * sizeof(unsigned int));
+
+	free(Clusters);
+	free(CacheOrder);
+}
+
+bool optimize_vertex_fetch(void* Vertices, size_t VertexSize, size_t VertexCount, unsigned int* Indices, size_t IndexCount)
+{
+	unsigned int* Remap = malloc(VertexCount * sizeof(unsigned int));
+	unsigned char* Output = malloc(VertexCount * VertexSize);
+
+	if (!Remap || !Output)
+	{
+		free(Remap);
+		free(Output);
+
+		return 0;
+	}
+
+	memset(Remap, 0xFF, VertexCount * sizeof(unsigned int));
+
+	unsigned int NextVertex = 0;
+
+	// Number vertices in the order they're first drawn so fetches walk the buffer forwards
+	for (size_t i = 0; i < IndexCount; ++i)
+	{
+		unsigned int Vertex = Indices[i];
+
+		if (Remap[Vertex] == UINT_MAX)
+		{
+			memcpy(&Output[NextVertex * VertexSize], &((unsigned char*)Vertices)[Vertex * VertexSize], VertexSize);
+			Remap[Vertex] = NextVertex++;
+		}
+
+		Indices[i] = Remap[Vertex];
+	}
+
+	// Anything never referenced goes at the end so the vertex count doesn't change
+	for (size_t i = 0; i < VertexCount; ++i)
+		if (Remap[i] == UINT_MAX)
+			memcpy(&Output[NextVertex++ * VertexSize], &((unsigned char*)Vertices)[i * VertexSize], VertexSize);
+
+	memcpy(Vertices, Output, VertexCount * VertexSize);
+
+	free(Remap);
+	free(Output);
+
+	return 1;
+}
+
+void analyze_vertex_cache(const unsigned int* Indices, size_t IndexCount, size_t VertexCount, size_t CacheSize, float* ACMR, float* ATVR)
+{
+	*ACMR = 0.f;
+	*ATVR = 0.f;
+
+	if (IndexCount < 3 || VertexCount == 0)
+		return;
+
+	// Simulates a FIFO cache, Times holds when each vertex was last inserted
+	size_t* Times = calloc(VertexCount, sizeof(size_t));
+
+	if (!Times)
+		return;
+
+	size_t Time = CacheSize + 1;
+	size_t Misses = 0;
+	size_t UniqueVertices = 0;
+
+	for (size_t i = 0; i < IndexCount; ++i)
+	{
+		unsigned int Vertex = Indices[i];
+
+		if (Times[Vertex] == 0)
+			UniqueVertices++;
+
+		if (Time - Times[Vertex] > CacheSize)
+		{
+			Times[Vertex] = Time++;
+			Misses++;
+		}
+	}
+
+	free(Times);
+
+	*ACMR = (float)Misses / (float)(IndexCount / 3);
+	*ATVR = (float)Misses / (float)UniqueVertices;
+}
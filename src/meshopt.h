@@ -0,0 +1,16 @@
+#ifndef ogt_mesh_opt
+#define ogt_mesh_opt
+
+#include <stddef.h>
+
+#define MESHOPT_CACHE_SIZE 16 // Post-transform cache entries to optimize for, small enough to suit most hardware
+#define MESHOPT_OVERDRAW_THRESHOLD 1.05f // How much ACMR the overdraw pass may give back
+
+// Indices are reordered in place, vertices are positions at the start of every Stride floats
+void optimize_mesh(const float* Vertices, size_t Stride, size_t VertexCount, unsigned int* Indices, size_t IndexCount);
+size_t optimize_vertex_cache(unsigned int* Indices, size_t IndexCount, size_t VertexCount, size_t CacheSize, size_t* Clusters); // Tipsify, returns the cluster count
+void optimize_overdraw(const float* Vertices, size_t Stride, unsigned int* Indices, size_t IndexCount, const size_t* Clusters, size_t ClusterCount);
+bool optimize_vertex_fetch(void* Vertices, size_t VertexSize, size_t VertexCount, unsigned int* Indices, size_t IndexCount);
+void analyze_vertex_cache(const unsigned int* Indices, size_t IndexCount, size_t VertexCount, size_t CacheSize, float* ACMR, float* ATVR);
+
+#endif
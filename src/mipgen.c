@@ -0,0 +1,379 @@
+#include "mipgen.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cglm/cglm.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MIPGEN_SSE 1
+#include <xmmintrin.h>
+#else
+#define MIPGEN_SSE 0
+#endif
+
+#if defined(__AVX__)
+#define MIPGEN_AVX 1
+#include <immintrin.h>
+#else
+#define MIPGEN_AVX 0
+#endif
+
+#define MIP_MAX_TAPS 8
+#define MIP_SRGB_TABLE_SIZE 4096 // Linear to sRGB steps, enough that every byte survives a round trip
+#define MIP_COVERAGE_STEPS 10
+
+typedef struct
+{
+	int Count;
+	int Offsets[MIP_MAX_TAPS]; // Source pixels from 2 * destination
+	float Weights[MIP_MAX_TAPS];
+} MipKernel_t;
+
+static float SRGBToLinear[256];
+static unsigned char LinearToSRGB[MIP_SRGB_TABLE_SIZE];
+static MipKernel_t Kernels[2];
+
+static float srgb_to_linear(float Value)
+{
+	return Value <= 0.04045f ? Value / 12.92f : powf((Value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linear_to_srgb(float Value)
+{
+	return Value <= 0.0031308f ? Value * 12.92f : 1.055f * powf(Value, 1.f / 2.4f) - 0.055f;
+}
+
+// Modified Bessel function of the first kind, the series converges quickly for the alphas used here
+static float bessel_i0(float X)
+{
+	float Sum = 1.f, Term = 1.f;
+
+	for (int k = 1; k < 32; ++k)
+	{
+		Term *= (X / (2.f * k)) * (X / (2.f * k));
+		Sum += Term;
+	}
+
+	return Sum;
+}
+
+static float kaiser_sinc(float Distance, float Radius)
+{
+	float Ratio = Distance / Radius;
+
+	if (fabsf(Ratio) >= 1.f)
+		return 0.f;
+
+	float Sinc = Distance == 0.f ? 1.f : sinf(GLM_PIf * Distance) / (GLM_PIf * Distance);
+	float Window = bessel_i0(MIP_KAISER_ALPHA * sqrtf(1.f - Ratio * Ratio)) / bessel_i0(MIP_KAISER_ALPHA);
+
+	return Sinc * Window;
+}
+
+void init_mip_tables()
+{
+	for (int i = 0; i < 256; ++i)
+		SRGBToLinear[i] = srgb_to_linear(i / 255.f);
+
+	for (int i = 0; i < MIP_SRGB_TABLE_SIZE; ++i)
+		LinearToSRGB[i] = (unsigned char)(linear_to_srgb((float)i / (MIP_SRGB_TABLE_SIZE - 1)) * 255.f + .5f);
+
+	MipKernel_t* Box = &Kernels[MIP_FILTER_BOX];
+	Box->Count = 2;
+	Box->Offsets[0] = 0;
+	Box->Offsets[1] = 1;
+	Box->Weights[0] = Box->Weights[1] = .5f;
+
+	// Destination pixel i is centred on source 2i + 1, taps sit at half pixel steps of the destination either side
+	MipKernel_t* Kaiser = &Kernels[MIP_FILTER_KAISER];
+	float Total = 0.f;
+
+	Kaiser->Count = MIP_MAX_TAPS;
+
+	for (int t = 0; t < MIP_MAX_TAPS; ++t)
+	{
+		Kaiser->Offsets[t] = t - 3;
+		Kaiser->Weights[t] = kaiser_sinc((Kaiser->Offsets[t] - .5f) * .5f, 2.f);
+
+		Total += Kaiser->Weights[t];
+	}
+
+	for (int t = 0; t < MIP_MAX_TAPS; ++t)
+		Kaiser->Weights[t] /= Total;
+}
+
+static float clamp_unit(float Value)
+{
+	return Value < 0.f ? 0.f : (Value > 1.f ? 1.f : Value);
+}
+
+static int clamp_index(int Index, int Size)
+{
+	return Index < 0 ? 0 : (Index >= Size ? Size - 1 : Index);
+}
+
+static float get_coverage(const MipChain_t* Chain, float Scale)
+{
+	size_t PixelCount = (size_t)Chain->Width * Chain->Height;
+	size_t Covered = 0;
+
+	for (size_t i = 0; i < PixelCount; ++i)
+		if (Chain->Linear[i * 4 + 3] * Scale > Chain->Options.AlphaCutoff)
+			Covered++;
+
+	return (float)Covered / PixelCount;
+}
+
+// Binary search, coverage only ever grows with the scale
+static float find_coverage_scale(const MipChain_t* Chain)
+{
+	float Low = 0.f, High = 4.f;
+
+	for (int i = 0; i < MIP_COVERAGE_STEPS; ++i)
+	{
+		float Middle = (Low + High) * .5f;
+
+		if (get_coverage(Chain, Middle) < Chain->Coverage)
+			Low = Middle;
+		else
+			High = Middle;
+	}
+
+	return (Low + High) * .5f;
+}
+
+static void filter_rows(const float* In, int Width, int Height, float* Out, int OutWidth, const MipKernel_t* Kernel)
+{
+	for (int y = 0; y < Height; ++y)
+	{
+		const float* Row = &In[(size_t)y * Width * 4];
+		float* OutRow = &Out[(size_t)y * OutWidth * 4];
+
+		for (int x = 0; x < OutWidth; ++x)
+		{
+#if MIPGEN_SSE
+			__m128 Sum = _mm_setzero_ps();
+
+			for (int t = 0; t < Kernel->Count; ++t)
+			{
+				const float* Pixel = &Row[clamp_index(x * 2 + Kernel->Offsets[t], Width) * 4];
+				Sum = _mm_add_ps(Sum, _mm_mul_ps(_mm_loadu_ps(Pixel), _mm_set1_ps(Kernel->Weights[t])));
+			}
+
+			_mm_storeu_ps(&OutRow[x * 4], Sum);
+#else
+			float Sum[4] = { 0 };
+
+			for (int t = 0; t < Kernel->Count; ++t)
+			{
+				const float* Pixel = &Row[clamp_index(x * 2 + Kernel->Offsets[t], Width) * 4];
+
+				for (int c = 0; c < 4; ++c)
+					Sum[c] += Pixel[c] * Kernel->Weights[t];
+			}
+
+			memcpy(&OutRow[x * 4], Sum, sizeof(Sum));
+#endif
+		}
+	}
+}
+
+// Every output pixel in a row uses the same source rows, so this runs straight along them
+static void filter_columns(const float* In, int Width, int Height, float* Out, int OutHeight, const MipKernel_t* Kernel)
+{
+	size_t RowFloats = (size_t)Width * 4;
+
+	for (int y = 0; y < OutHeight; ++y)
+	{
+		const float* Rows[MIP_MAX_TAPS];
+
+		for (int t = 0; t < Kernel->Count; ++t)
+			Rows[t] = &In[clamp_index(y * 2 + Kernel->Offsets[t], Height) * RowFloats];
+
+		float* OutRow = &Out[y * RowFloats];
+		size_t i = 0;
+
+#if MIPGEN_AVX
+		for (; i + 8 <= RowFloats; i += 8)
+		{
+			__m256 Sum = _mm256_setzero_ps();
+
+			for (int t = 0; t < Kernel->Count; ++t)
+				Sum = _mm256_add_ps(Sum, _mm256_mul_ps(_mm256_loadu_ps(&Rows[t][i]), _mm256_set1_ps(Kernel->Weights[t])));
+
+			_mm256_storeu_ps(&OutRow[i], Sum);
+		}
+#endif
+
+#if MIPGEN_SSE
+		for (; i + 4 <= RowFloats; i += 4)
+		{
+			__m128 Sum = _mm_setzero_ps();
+
+			for (int t = 0; t < Kernel->Count; ++t)
+				Sum = _mm_add_ps(Sum, _mm_mul_ps(_mm_loadu_ps(&Rows[t][i]), _mm_set1_ps(Kernel->Weights[t])));
+
+			_mm_storeu_ps(&OutRow[i], Sum);
+		}
+#endif
+
+		for (; i < RowFloats; ++i)
+		{
+			float Sum = 0.f;
+
+			for (int t = 0; t < Kernel->Count; ++t)
+				Sum += Rows[t][i] * Kernel->Weights[t];
+
+			OutRow[i] = Sum;
+		}
+	}
+}
+
+void get_default_mip_options(MipOptions_t* Options)
+{
+	Options->Filter = MIP_FILTER_KAISER;
+	Options->SRGB = 1;
+	Options->PreserveCoverage = 0;
+	Options->AlphaCutoff = MIP_ALPHA_CUTOFF;
+}
+
+static void decode_row(const MipChain_t* Chain, int Row, float* Out)
+{
+	int Channels = Chain->Channels;
+	bool SRGB = Chain->Options.SRGB && Channels >= 3;
+	const unsigned char* In = &Chain->Source[(size_t)Row * Chain->Width * Channels];
+
+	for (int x = 0; x < Chain->Width; ++x, In += Channels, Out += 4)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			unsigned char Value = In[Channels >= 3 ? c : 0];
+			Out[c] = SRGB ? SRGBToLinear[Value] : Value / 255.f;
+		}
+
+		Out[3] = Channels == 4 || Channels == 2 ? In[Channels - 1] / 255.f : 1.f;
+	}
+}
+
+bool begin_mip_chain(MipChain_t* Chain, const unsigned char* Pixels, int Width, int Height, int Channels, const MipOptions_t* Options)
+{
+	int NextWidth = Width > 1 ? Width / 2 : 1;
+	int NextHeight = Height > 1 ? Height / 2 : 1;
+
+	Chain->Options = *Options;
+	Chain->Channels = Channels;
+	Chain->Width = Width;
+	Chain->Height = Height;
+	Chain->Source = Pixels;
+	Chain->Linear = malloc((size_t)NextWidth * NextHeight * 4 * sizeof(float));
+	Chain->Scratch = malloc((size_t)NextWidth * Height * 4 * sizeof(float));
+	Chain->Row = malloc((size_t)Width * 4 * sizeof(float));
+	Chain->Coverage = 1.f;
+	Chain->AlphaScale = 1.f;
+
+	if (!Chain->Linear || !Chain->Scratch || !Chain->Row)
+	{
+		end_mip_chain(Chain);
+		return 0;
+	}
+
+	if (Options->PreserveCoverage && (Channels == 4 || Channels == 2))
+	{
+		size_t PixelCount = (size_t)Width * Height;
+		size_t Covered = 0;
+
+		for (size_t i = 0; i < PixelCount; ++i)
+			if (Pixels[i * Channels + Channels - 1] / 255.f > Options->AlphaCutoff)
+				Covered++;
+
+		Chain->Coverage = (float)Covered / PixelCount;
+	}
+	else
+		Chain->Options.PreserveCoverage = 0;
+
+	return 1;
+}
+
+bool next_mip_level(MipChain_t* Chain)
+{
+	if (Chain->Width == 1 && Chain->Height == 1)
+		return 0;
+
+	const MipKernel_t* Kernel = &Kernels[Chain->Options.Filter];
+	int Width = Chain->Width > 1 ? Chain->Width / 2 : 1;
+	int Height = Chain->Height > 1 ? Chain->Height / 2 : 1;
+
+	// Level 0 is converted a row at a time on the way through, it's by far the biggest
+	if (Chain->Source)
+	{
+		for (int y = 0; y < Chain->Height; ++y)
+		{
+			float* Out = &Chain->Scratch[(size_t)y * Width * 4];
+
+			if (Chain->Width > 1)
+			{
+				decode_row(Chain, y, Chain->Row);
+				filter_rows(Chain->Row, Chain->Width, 1, Out, Width, Kernel);
+			}
+			else
+				decode_row(Chain, y, Out);
+		}
+
+		Chain->Source = NULL;
+	}
+	else if (Chain->Width > 1)
+		filter_rows(Chain->Linear, Chain->Width, Chain->Height, Chain->Scratch, Width, Kernel);
+	else
+		memcpy(Chain->Scratch, Chain->Linear, (size_t)Chain->Height * 4 * sizeof(float)); // A side already at 1 is copied through
+
+	if (Chain->Height > 1)
+		filter_columns(Chain->Scratch, Width, Chain->Height, Chain->Linear, Height, Kernel);
+	else
+		memcpy(Chain->Linear, Chain->Scratch, (size_t)Width * 4 * sizeof(float));
+
+	Chain->Width = Width;
+	Chain->Height = Height;
+
+	if (Chain->Options.PreserveCoverage)
+		Chain->AlphaScale = find_coverage_scale(Chain);
+
+	return 1;
+}
+
+void read_mip_level(const MipChain_t* Chain, unsigned char* Pixels)
+{
+	size_t PixelCount = (size_t)Chain->Width * Chain->Height;
+	int Channels = Chain->Channels;
+	bool SRGB = Chain->Options.SRGB && Channels >= 3;
+
+	for (size_t i = 0; i < PixelCount; ++i)
+	{
+		const float* In = &Chain->Linear[i * 4];
+		unsigned char* Out = &Pixels[i * Channels];
+		int ColorChannels = Channels >= 3 ? 3 : 1;
+
+		for (int c = 0; c < ColorChannels; ++c)
+		{
+			float Value = clamp_unit(In[c]);
+
+			Out[c] = SRGB
+				? LinearToSRGB[(int)(Value * (MIP_SRGB_TABLE_SIZE - 1) + .5f)]
+				: (unsigned char)(Value * 255.f + .5f);
+		}
+
+		if (Channels == 4 || Channels == 2)
+			Out[Channels - 1] = (unsigned char)(clamp_unit(In[3] * Chain->AlphaScale) * 255.f + .5f);
+	}
+}
+
+void end_mip_chain(MipChain_t* Chain)
+{
+	free(Chain->Linear);
+	free(Chain->Scratch);
+	free(Chain->Row);
+
+	Chain->Linear = NULL;
+	Chain->Scratch = NULL;
+	Chain->Row = NULL;
+}
@@ -0,0 +1,45 @@
+#ifndef ogt_mipgen
+#define ogt_mipgen
+
+#include <stddef.h>
+
+#define MIP_KAISER_ALPHA 4.0f
+#define MIP_ALPHA_CUTOFF 0.5f // Default alpha test threshold coverage is kept for
+
+typedef enum
+{
+	MIP_FILTER_BOX,
+	MIP_FILTER_KAISER // Windowed sinc over 8 taps, keeps more detail than the box without much ringing
+} MipFilter_t;
+
+typedef struct
+{
+	MipFilter_t Filter;
+	bool SRGB; // Filters RGB in linear light, single channel images are always treated as linear data
+	bool PreserveCoverage; // Scales alpha so every level passes AlphaCutoff as often as level 0 does
+	float AlphaCutoff;
+} MipOptions_t;
+
+// Levels are kept as linear float RGBA between steps, so rounding doesn't pile up down the chain
+typedef struct
+{
+	MipOptions_t Options;
+	int Channels;
+	int Width;
+	int Height;
+	const unsigned char* Source; // Level 0, until the first step has read it
+	float* Linear; // Current level from the first step on
+	float* Scratch;
+	float* Row;
+	float Coverage; // Level 0's, when preserving it
+	float AlphaScale; // Applied when reading the current level back
+} MipChain_t;
+
+void init_mip_tables(); // Once on the main thread before any chains are made
+void get_default_mip_options(MipOptions_t* Options);
+bool begin_mip_chain(MipChain_t* Chain, const unsigned char* Pixels, int Width, int Height, int Channels, const MipOptions_t* Options); // Safe off the main thread
+bool next_mip_level(MipChain_t* Chain); // Halves the current level, 0 when it's already 1x1
+void read_mip_level(const MipChain_t* Chain, unsigned char* Pixels); // Back to 8 bits with the source's channel count, not for level 0
+void end_mip_chain(MipChain_t* Chain);
+
+#endif
@@ -0,0 +1,401 @@
+#include "modelcache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cglm/cglm.h>
+
+#include "util.h"
+#include "objparse.h"
+
+static char* get_cache_path(const char* ModelPath)
+{
+	size_t Length = strlen(ModelPath);
+	char* CachePath = malloc(Length + sizeof(MODEL_CACHE_EXTENSION));
+
+	if (!CachePath)
+		return NULL;
+
+	memcpy(CachePath, ModelPath, Length);
+	memcpy(CachePath + Length, MODEL_CACHE_EXTENSION, sizeof(MODEL_CACHE_EXTENSION));
+
+	return CachePath;
+}
+
+static bool is_source_newer(const char* SourcePath, time_t CacheTime)
+{
+	time_t SourceTime;
+
+	if (!get_file_time(SourcePath, &SourceTime))
+		return 0; // Source is gone, the cache is all we have
+
+	return SourceTime > CacheTime;
+}
+
+static bool is_cache_stale(const char* ModelPath, const char* CachePath, time_t* CacheTime)
+{
+	if (!get_file_time(CachePath, CacheTime))
+		return 1;
+
+	return is_source_newer(ModelPath, *CacheTime);
+}
+
+static bool is_range_valid(size_t Size, uint64_t Offset, uint64_t Length)
+{
+	return Offset <= Size && Length <= Size - Offset;
+}
+
+static bool are_lods_valid(const ModelCacheLod_t* Lods, uint32_t LodCount, uint32_t IndexCount)
+{
+	for (uint32_t i = 0; i < LodCount; ++i)
+		if (!is_range_valid(IndexCount, Lods[i].FirstIndex, Lods[i].IndexCount))
+			return 0;
+
+	return 1;
+}
+
+static void read_lods(const ModelCacheLod_t* In, MeshLod_t* Out, uint32_t LodCount)
+{
+	for (uint32_t i = 0; i < LodCount; ++i)
+	{
+		Out[i].FirstIndex = (size_t)In[i].FirstIndex;
+		Out[i].IndexCount = (size_t)In[i].IndexCount;
+	}
+}
+
+static void write_lods(const MeshLod_t* In, ModelCacheLod_t* Out, size_t LodCount)
+{
+	for (size_t i = 0; i < LodCount; ++i)
+	{
+		Out[i].FirstIndex = In[i].FirstIndex;
+		Out[i].IndexCount = In[i].IndexCount;
+	}
+}
+
+bool load_model_cache(ModelInfo_t* ModelInfo)
+{
+	ModelInfo->CacheData = NULL;
+	ModelInfo->CacheSize = 0;
+
+	char* CachePath = get_cache_path(ModelInfo->ModelPath);
+
+	if (!CachePath)
+		return 0;
+
+	time_t CacheTime;
+
+	if (is_cache_stale(ModelInfo->ModelPath, CachePath, &CacheTime))
+	{
+		free(CachePath);
+
+		return 0;
+	}
+
+	void* Data;
+	size_t Size;
+	bool Mapped = map_file(CachePath, &Data, &Size);
+
+	free(CachePath);
+
+	if (!Mapped)
+		return 0;
+
+	const unsigned char* Base = (const unsigned char*)Data;
+	const ModelCacheHeader_t* Header = (const ModelCacheHeader_t*)Base;
+
+	if (
+		Size < sizeof(ModelCacheHeader_t)
+		|| Header->Magic != MODEL_CACHE_MAGIC
+		|| Header->Version != MODEL_CACHE_VERSION
+		|| Header->ChunkSize != OBJ_CHUNK_SIZE
+		|| Header->LodCount < 1
+		|| Header->LodCount > MODEL_MAX_LODS
+		|| !are_lods_valid(Header->Lods, Header->LodCount, Header->IndexCount)
+		|| !is_range_valid(Size, Header->MaterialOffset, (uint64_t)Header->MaterialCount * sizeof(ModelCacheMaterial_t))
+		|| !is_range_valid(Size, Header->SubmeshOffset, (uint64_t)Header->SubmeshCount * sizeof(ModelCacheSubmesh_t))
+		|| !is_range_valid(Size, Header->StringOffset, Header->StringSize)
+		|| !is_range_valid(Size, Header->VertexOffset, (uint64_t)Header->VertexCount * OBJ_CHUNK_SIZE)
+		|| !is_range_valid(Size, Header->IndexOffset, (uint64_t)Header->IndexCount * sizeof(uint32_t))
+	)
+	{
+		printf("Ignoring invalid model cache for '%s'\n", ModelInfo->ModelPath);
+
+		unmap_file(Data, Size);
+
+		return 0;
+	}
+
+	const ModelCacheMaterial_t* InMaterials = (const ModelCacheMaterial_t*)(Base + Header->MaterialOffset);
+	const ModelCacheSubmesh_t* InSubmeshes = (const ModelCacheSubmesh_t*)(Base + Header->SubmeshOffset);
+	const char* Strings = (const char*)(Base + Header->StringOffset);
+
+	// Material colours and texture paths come from the mtllib, editing it alone has to rebuild the cache too
+	if (
+		Header->MaterialLibrary < Header->StringSize
+		&& memchr(Strings + Header->MaterialLibrary, '\0', Header->StringSize - Header->MaterialLibrary)
+		&& is_source_newer(Strings + Header->MaterialLibrary, CacheTime)
+	)
+	{
+		unmap_file(Data, Size);
+
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < Header->SubmeshCount; ++i)
+	{
+		if (!are_lods_valid(InSubmeshes[i].Lods, Header->LodCount, Header->IndexCount))
+		{
+			printf("Ignoring invalid model cache for '%s'\n", ModelInfo->ModelPath);
+
+			unmap_file(Data, Size);
+
+			return 0;
+		}
+	}
+
+	Material_t* Materials = NULL;
+	Mesh_t* Submeshes = NULL;
+
+	if (Header->MaterialCount > 0)
+	{
+		Materials = calloc(Header->MaterialCount, sizeof(Material_t));
+
+		if (!Materials)
+		{
+			unmap_file(Data, Size);
+
+			return 0;
+		}
+
+		for (uint32_t i = 0; i < Header->MaterialCount; ++i)
+		{
+			const ModelCacheMaterial_t* In = &InMaterials[i];
+			Material_t* Out = &Materials[i];
+
+			if (In->TexturePath < Header->StringSize && memchr(Strings + In->TexturePath, '\0', Header->StringSize - In->TexturePath))
+				Out->TexturePath = strdup(Strings + In->TexturePath);
+
+			glm_vec3_copy((float*)In->AmbientColor, Out->AmbientColor);
+			glm_vec3_copy((float*)In->DiffuseColor, Out->DiffuseColor);
+			glm_vec3_copy((float*)In->SpecularColor, Out->SpecularColor);
+
+			Out->SpecularExponent = In->SpecularExponent;
+			Out->Dissolve = In->Dissolve;
+			Out->Illumination = In->Illumination;
+		}
+	}
+
+	if (Header->SubmeshCount > 0)
+	{
+		Submeshes = malloc(Header->SubmeshCount * sizeof(Mesh_t));
+
+		if (!Submeshes)
+		{
+			free(Materials);
+			unmap_file(Data, Size);
+
+			return 0;
+		}
+
+		for (uint32_t i = 0; i < Header->SubmeshCount; ++i)
+		{
+			const ModelCacheSubmesh_t* In = &InSubmeshes[i];
+			Mesh_t* Out = &Submeshes[i];
+
+			read_lods(In->Lods, Out->Lods, Header->LodCount);
+			Out->Material = (In->Material >= 0 && In->Material < Header->MaterialCount) ? &Materials[In->Material] : NULL;
+
+			glm_vec3_copy((float*)In->Mins, Out->Mins);
+			glm_vec3_copy((float*)In->Maxs, Out->Maxs);
+		}
+	}
+
+	ModelInfo->Vertices = (float*)(Base + Header->VertexOffset);
+	ModelInfo->VertexCount = Header->VertexCount;
+	ModelInfo->Indices = (unsigned int*)(Base + Header->IndexOffset);
+	ModelInfo->IndexCount = Header->IndexCount;
+	ModelInfo->MeshCount = 1;
+	ModelInfo->MaterialCount = Header->MaterialCount;
+	ModelInfo->Materials = Materials;
+	ModelInfo->Submeshes = Submeshes;
+	ModelInfo->SubmeshCount = Header->SubmeshCount;
+	ModelInfo->LodCount = Header->LodCount;
+
+	read_lods(Header->Lods, ModelInfo->Lods, Header->LodCount);
+	memcpy(ModelInfo->LodErrors, Header->LodErrors, sizeof(ModelInfo->LodErrors));
+
+	glm_vec3_copy((float*)Header->Mins, ModelInfo->Mins);
+	glm_vec3_copy((float*)Header->Maxs, ModelInfo->Maxs);
+	glm_vec3_copy((float*)Header->SphereCenter, ModelInfo->SphereCenter);
+	ModelInfo->SphereRadius = Header->SphereRadius;
+
+	ModelInfo->CacheData = Data;
+	ModelInfo->CacheSize = Size;
+
+	return 1;
+}
+
+void save_model_cache(ModelInfo_t* ModelInfo)
+{
+	char* CachePath = get_cache_path(ModelInfo->ModelPath);
+
+	if (!CachePath)
+		return;
+
+	ModelCacheHeader_t Header = { 0 };
+	Header.Magic = MODEL_CACHE_MAGIC;
+	Header.Version = MODEL_CACHE_VERSION;
+	Header.ChunkSize = OBJ_CHUNK_SIZE;
+	Header.VertexCount = (uint32_t)ModelInfo->VertexCount;
+	Header.IndexCount = (uint32_t)ModelInfo->IndexCount;
+	Header.MaterialCount = (uint32_t)ModelInfo->MaterialCount;
+	Header.SubmeshCount = (uint32_t)ModelInfo->SubmeshCount;
+	Header.LodCount = (uint32_t)ModelInfo->LodCount;
+
+	write_lods(ModelInfo->Lods, Header.Lods, ModelInfo->LodCount);
+	memcpy(Header.LodErrors, ModelInfo->LodErrors, sizeof(Header.LodErrors));
+
+	glm_vec3_copy(ModelInfo->Mins, Header.Mins);
+	glm_vec3_copy(ModelInfo->Maxs, Header.Maxs);
+	glm_vec3_copy(ModelInfo->SphereCenter, Header.SphereCenter);
+	Header.SphereRadius = ModelInfo->SphereRadius;
+
+	ModelCacheMaterial_t* OutMaterials = calloc(ModelInfo->MaterialCount + 1, sizeof(ModelCacheMaterial_t));
+	ModelCacheSubmesh_t* OutSubmeshes = calloc(ModelInfo->SubmeshCount + 1, sizeof(ModelCacheSubmesh_t));
+
+	if (!OutMaterials || !OutSubmeshes)
+	{
+		free(OutMaterials);
+		free(OutSubmeshes);
+		free(CachePath);
+
+		return;
+	}
+
+	for (size_t i = 0; i < ModelInfo->MaterialCount; ++i)
+	{
+		const Material_t* In = &ModelInfo->Materials[i];
+		ModelCacheMaterial_t* Out = &OutMaterials[i];
+
+		glm_vec3_copy((float*)In->AmbientColor, Out->AmbientColor);
+		glm_vec3_copy((float*)In->DiffuseColor, Out->DiffuseColor);
+		glm_vec3_copy((float*)In->SpecularColor, Out->SpecularColor);
+
+		Out->SpecularExponent = In->SpecularExponent;
+		Out->Dissolve = In->Dissolve;
+		Out->Illumination = In->Illumination;
+
+		if (In->TexturePath)
+		{
+			Out->TexturePath = (uint32_t)Header.StringSize;
+			Header.StringSize += strlen(In->TexturePath) + 1;
+		}
+		else
+			Out->TexturePath = UINT32_MAX;
+	}
+
+	char* MaterialLibrary = find_obj_material_library(ModelInfo->ModelPath);
+
+	if (MaterialLibrary)
+	{
+		Header.MaterialLibrary = Header.StringSize;
+		Header.StringSize += strlen(MaterialLibrary) + 1;
+	}
+	else
+		Header.MaterialLibrary = UINT64_MAX;
+
+	for (size_t i = 0; i < ModelInfo->SubmeshCount; ++i)
+	{
+		const Mesh_t* In = &ModelInfo->Submeshes[i];
+		ModelCacheSubmesh_t* Out = &OutSubmeshes[i];
+
+		write_lods(In->Lods, Out->Lods, ModelInfo->LodCount);
+		Out->Material = In->Material ? (int64_t)(In->Material - ModelInfo->Materials) : -1;
+
+		glm_vec3_copy((float*)In->Mins, Out->Mins);
+		glm_vec3_copy((float*)In->Maxs, Out->Maxs);
+	}
+
+	Header.MaterialOffset = sizeof(ModelCacheHeader_t);
+	Header.SubmeshOffset = Header.MaterialOffset + Header.MaterialCount * sizeof(ModelCacheMaterial_t);
+	Header.StringOffset = Header.SubmeshOffset + Header.SubmeshCount * sizeof(ModelCacheSubmesh_t);
+	Header.VertexOffset = (Header.StringOffset + Header.StringSize + 15) & ~(uint64_t)15;
+	Header.IndexOffset = Header.VertexOffset + Header.VertexCount * OBJ_CHUNK_SIZE;
+
+	size_t Length = strlen(CachePath);
+	char* TempPath = malloc(Length + 32);
+	FILE* File = NULL;
+
+	// Written aside and renamed over so a crash or another instance never maps half a file
+	if (TempPath)
+	{
+		snprintf(TempPath, Length + 32, "%s.%p.tmp", CachePath, (void*)ModelInfo);
+		File = fopen(TempPath, "wb");
+	}
+
+	if (!File)
+	{
+		printf("Failed to open model cache '%s' for writing\n", CachePath);
+
+		free(TempPath);
+		free(MaterialLibrary);
+		free(OutMaterials);
+		free(OutSubmeshes);
+		free(CachePath);
+
+		return;
+	}
+
+	bool Written = fwrite(&Header, sizeof(Header), 1, File) == 1;
+	Written = Written && fwrite(OutMaterials, sizeof(ModelCacheMaterial_t), Header.MaterialCount, File) == Header.MaterialCount;
+	Written = Written && fwrite(OutSubmeshes, sizeof(ModelCacheSubmesh_t), Header.SubmeshCount, File) == Header.SubmeshCount;
+
+	for (size_t i = 0; Written && i < ModelInfo->MaterialCount; ++i)
+	{
+		const char* TexturePath = ModelInfo->Materials[i].TexturePath;
+
+		if (TexturePath)
+			Written = fwrite(TexturePath, strlen(TexturePath) + 1, 1, File) == 1;
+	}
+
+	if (Written && MaterialLibrary)
+		Written = fwrite(MaterialLibrary, strlen(MaterialLibrary) + 1, 1, File) == 1;
+
+	static const char Padding[16] = { 0 };
+	size_t PaddingSize = Header.VertexOffset - (Header.StringOffset + Header.StringSize);
+
+	if (Written && PaddingSize > 0)
+		Written = fwrite(Padding, 1, PaddingSize, File) == PaddingSize;
+
+	Written = Written && fwrite(ModelInfo->Vertices, OBJ_CHUNK_SIZE, ModelInfo->VertexCount, File) == ModelInfo->VertexCount;
+	Written = Written && fwrite(ModelInfo->Indices, sizeof(uint32_t), ModelInfo->IndexCount, File) == ModelInfo->IndexCount;
+
+	Written = fclose(File) == 0 && Written;
+
+	if (!Written)
+	{
+		printf("Failed to write model cache '%s'\n", CachePath);
+		remove(TempPath);
+	}
+	else if (rename(TempPath, CachePath) != 0)
+	{
+		remove(CachePath); // Windows won't rename over an existing file
+
+		if (rename(TempPath, CachePath) != 0)
+			remove(TempPath);
+	}
+
+	free(TempPath);
+	free(MaterialLibrary);
+	free(OutMaterials);
+	free(OutSubmeshes);
+	free(CachePath);
+}
+
+void free_model_cache(ModelInfo_t* ModelInfo)
+{
+	unmap_file(ModelInfo->CacheData, ModelInfo->CacheSize);
+
+	ModelInfo->CacheData = NULL;
+	ModelInfo->CacheSize = 0;
+}
@@ -0,0 +1,73 @@
+#ifndef ogt_model_cache
+#define ogt_model_cache
+
+#include <stdint.h>
+
+#include "models.h"
+
+#define MODEL_CACHE_MAGIC 0x4D54474F // "OGTM"
+#define MODEL_CACHE_VERSION 8
+#define MODEL_CACHE_EXTENSION ".ogtm"
+
+typedef struct
+{
+	uint64_t FirstIndex;
+	uint64_t IndexCount;
+} ModelCacheLod_t;
+
+// Everything is stored in native byte order, the cache is rebuilt from the OBJ whenever it doesn't match
+typedef struct
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t ChunkSize;
+	uint32_t VertexCount;
+	uint32_t IndexCount;
+	uint32_t MaterialCount;
+	uint32_t SubmeshCount;
+	uint32_t LodCount;
+
+	float Mins[3];
+	float Maxs[3];
+	float SphereCenter[3];
+	float SphereRadius;
+
+	ModelCacheLod_t Lods[MODEL_MAX_LODS];
+	float LodErrors[MODEL_MAX_LODS];
+
+	uint64_t MaterialOffset;
+	uint64_t SubmeshOffset;
+	uint64_t StringOffset;
+	uint64_t StringSize;
+	uint64_t MaterialLibrary; // Offset into the string table, UINT64_MAX for none. The cache is stale once it's newer
+	uint64_t VertexOffset;
+	uint64_t IndexOffset;
+} ModelCacheHeader_t;
+
+typedef struct
+{
+	float AmbientColor[3];
+	float DiffuseColor[3];
+	float SpecularColor[3];
+	float SpecularExponent;
+	float Dissolve;
+	int32_t Illumination;
+
+	uint32_t TexturePath; // Offset into the string table, UINT32_MAX for none
+	uint32_t Pad;
+} ModelCacheMaterial_t;
+
+typedef struct
+{
+	ModelCacheLod_t Lods[MODEL_MAX_LODS];
+	int64_t Material; // Index into the material table, -1 for none
+
+	float Mins[3];
+	float Maxs[3];
+} ModelCacheSubmesh_t;
+
+bool load_model_cache(ModelInfo_t* ModelInfo);
+void save_model_cache(ModelInfo_t* ModelInfo);
+void free_model_cache(ModelInfo_t* ModelInfo);
+
+#endif
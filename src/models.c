@@ -1,60 +1,293 @@
 #include "models.h"
 
+#include <stdio.h>
+#include <string.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <cglm/cglm.h>
 
-#define TINYOBJ_LOADER_C_IMPLEMENTATION
-#include <tinyobj_loader_c.h>
-
 #include "globals.h"
 #include "util.h"
+#include "modelcache.h"
+#include "objparse.h"
+#include "meshopt.h"
+#include "simplify.h"
+#include "jobs.h"
+#include "geometry.h"
+#include "normals.h"
+
+static size_t get_material_bucket(int MaterialID, size_t MaterialCount)
+{
+	return (MaterialID >= 0 && MaterialID < (int)MaterialCount) ? (size_t)MaterialID : MaterialCount;
+}
+
+static void compute_index_bounds(const float* Vertices, const unsigned int* Indices, size_t IndexCount, vec3 Mins, vec3 Maxs)
+{
+	glm_vec3_zero(Mins);
+	glm_vec3_zero(Maxs);
+
+	if (IndexCount == 0)
+		return;
+
+	glm_vec3_copy((float*)&Vertices[Indices[0] * OBJ_CHUNK_FLOATS], Mins);
+	glm_vec3_copy((float*)&Vertices[Indices[0] * OBJ_CHUNK_FLOATS], Maxs);
+
+	for (size_t i = 1; i < IndexCount; ++i)
+	{
+		float* Position = (float*)&Vertices[Indices[i] * OBJ_CHUNK_FLOATS];
+
+		glm_vec3_minv(Mins, Position, Mins);
+		glm_vec3_maxv(Maxs, Position, Maxs);
+	}
+}
+
+// Ritter's sphere, starts from the most separated pair of axis extremes and grows to take in stragglers
+static void compute_bounding_sphere(const float* Vertices, size_t VertexCount, vec3 Center, float* Radius)
+{
+	glm_vec3_zero(Center);
+	*Radius = 0.f;
+
+	if (VertexCount == 0)
+		return;
+
+	size_t MinIndex[3] = { 0, 0, 0 };
+	size_t MaxIndex[3] = { 0, 0, 0 };
+
+	for (size_t i = 1; i < VertexCount; ++i)
+	{
+		const float* Position = &Vertices[i * OBJ_CHUNK_FLOATS];
+
+		for (int Axis = 0; Axis < 3; ++Axis)
+		{
+			if (Position[Axis] < Vertices[(MinIndex[Axis] * OBJ_CHUNK_FLOATS) + Axis])
+				MinIndex[Axis] = i;
+
+			if (Position[Axis] > Vertices[(MaxIndex[Axis] * OBJ_CHUNK_FLOATS) + Axis])
+				MaxIndex[Axis] = i;
+		}
+	}
 
-static void get_file_data(void* _, const char* Path, const int IsMaterial, const char* OBJPath, char** Data, size_t* Length)
+	int Widest = 0;
+	float WidestDistance = -1.f;
+
+	for (int Axis = 0; Axis < 3; ++Axis)
+	{
+		float Distance = glm_vec3_distance2((float*)&Vertices[MinIndex[Axis] * OBJ_CHUNK_FLOATS], (float*)&Vertices[MaxIndex[Axis] * OBJ_CHUNK_FLOATS]);
+
+		if (Distance > WidestDistance)
+		{
+			Widest = Axis;
+			WidestDistance = Distance;
+		}
+	}
+
+	glm_vec3_center((float*)&Vertices[MinIndex[Widest] * OBJ_CHUNK_FLOATS], (float*)&Vertices[MaxIndex[Widest] * OBJ_CHUNK_FLOATS], Center);
+	*Radius = sqrtf(WidestDistance) * .5f;
+
+	for (size_t i = 0; i < VertexCount; ++i)
+	{
+		float* Position = (float*)&Vertices[i * OBJ_CHUNK_FLOATS];
+		float Distance = glm_vec3_distance(Position, Center);
+
+		if (Distance <= *Radius)
+			continue;
+
+		// Move the center towards the point just far enough to cover it
+		float NewRadius = (*Radius + Distance) * .5f;
+
+		vec3 Direction;
+		glm_vec3_sub(Position, Center, Direction);
+		glm_vec3_scale(Direction, (NewRadius - *Radius) / Distance, Direction);
+		glm_vec3_add(Center, Direction, Center);
+
+		*Radius = NewRadius;
+	}
+}
+
+// Without submeshes the whole model is the only range
+static MeshLod_t* get_range_lods(ModelInfo_t* ModelInfo, size_t Range)
 {
-	read_file(Path, Data, Length);
+	return ModelInfo->SubmeshCount > 0 ? ModelInfo->Submeshes[Range].Lods : ModelInfo->Lods;
+}
+
+// Simplifies each submesh into the following LODs and optimizes every range, returns the new index count
+static size_t build_model_lods(ModelInfo_t* ModelInfo, float* Vertices, size_t VertexCount, unsigned int** IndicesRef, size_t IndexCount)
+{
+	size_t RangeCount = ModelInfo->SubmeshCount > 0 ? ModelInfo->SubmeshCount : 1;
+	float Radius = get_model_radius(ModelInfo);
+
+	ModelInfo->Lods[0].FirstIndex = 0;
+	ModelInfo->Lods[0].IndexCount = IndexCount;
+	ModelInfo->LodErrors[0] = 0.f;
+	ModelInfo->LodCount = 1;
+
+	// Triangles only move within their submesh so the material ranges stay intact
+	for (size_t Range = 0; Range < RangeCount; ++Range)
+	{
+		MeshLod_t* Lod = &get_range_lods(ModelInfo, Range)[0];
+
+		optimize_mesh(Vertices, OBJ_CHUNK_FLOATS, VertexCount, &(*IndicesRef)[Lod->FirstIndex], Lod->IndexCount);
+	}
+
+	// Degenerate and empty models have nothing to simplify, and realloc to 0 bytes isn't defined
+	unsigned int* Indices = NULL;
+	size_t TotalIndices = IndexCount;
+
+	// Simplifying never adds triangles, so this is always enough room
+	if (Radius > 0.f && IndexCount > 0)
+		Indices = realloc(*IndicesRef, IndexCount * MODEL_MAX_LODS * sizeof(unsigned int));
+
+	if (Indices)
+	{
+		*IndicesRef = Indices;
+
+		for (size_t Level = 1; Level < MODEL_MAX_LODS; ++Level)
+		{
+			size_t LevelStart = TotalIndices;
+			float LevelError = ModelInfo->LodErrors[Level - 1];
+
+			for (size_t Range = 0; Range < RangeCount; ++Range)
+			{
+				MeshLod_t* Lods = get_range_lods(ModelInfo, Range);
+				size_t TargetIndexCount = (size_t)((Lods[Level - 1].IndexCount / 3) * MODEL_LOD_REDUCTION) * 3;
+				float Error;
+
+				Lods[Level].FirstIndex = TotalIndices;
+				Lods[Level].IndexCount = simplify_mesh(
+					Vertices,
+					OBJ_CHUNK_FLOATS,
+					VertexCount,
+					&Indices[Lods[Level - 1].FirstIndex],
+					Lods[Level - 1].IndexCount,
+					&Indices[TotalIndices],
+					TargetIndexCount < 3 ? 3 : TargetIndexCount,
+					MODEL_LOD_MAX_ERROR * Radius,
+					&Error
+				);
+
+				TotalIndices += Lods[Level].IndexCount;
+				LevelError = glm_max(LevelError, Error / Radius);
+			}
+
+			size_t LevelIndexCount = TotalIndices - LevelStart;
+
+			if (LevelIndexCount > ModelInfo->Lods[Level - 1].IndexCount * MODEL_LOD_MIN_REDUCTION)
+			{
+				TotalIndices = LevelStart;
+				break;
+			}
+
+			for (size_t Range = 0; Range < RangeCount; ++Range)
+			{
+				MeshLod_t* Lod = &get_range_lods(ModelInfo, Range)[Level];
+
+				optimize_mesh(Vertices, OBJ_CHUNK_FLOATS, VertexCount, &Indices[Lod->FirstIndex], Lod->IndexCount);
+			}
+
+			ModelInfo->Lods[Level].FirstIndex = LevelStart;
+			ModelInfo->Lods[Level].IndexCount = LevelIndexCount;
+			ModelInfo->LodErrors[Level] = LevelError;
+			ModelInfo->LodCount++;
+		}
+
+		Indices = realloc(*IndicesRef, TotalIndices * sizeof(unsigned int));
+
+		if (Indices)
+			*IndicesRef = Indices;
+	}
+
+	// LOD 0 uses every vertex and comes first, so this orders vertices for it
+	optimize_vertex_fetch(Vertices, OBJ_CHUNK_SIZE, VertexCount, *IndicesRef, TotalIndices);
+
+	return TotalIndices;
 }
 
 void load_obj(ModelInfo_t* ModelInfo)
 {
 	ModelInfo->Vertices = NULL;
 	ModelInfo->VertexCount = 0;
+	ModelInfo->Indices = NULL;
+	ModelInfo->IndexCount = 0;
 	ModelInfo->MeshCount = 0;
 	ModelInfo->MaterialCount = 0;
 	ModelInfo->Materials = NULL;
 	ModelInfo->Submeshes = NULL;
 	ModelInfo->SubmeshCount = 0;
+	ModelInfo->LodCount = 0;
+
+	glm_vec3_zero(ModelInfo->Mins);
+	glm_vec3_zero(ModelInfo->Maxs);
+	glm_vec3_zero(ModelInfo->SphereCenter);
+	ModelInfo->SphereRadius = 0.f;
+
+	ModelInfo->CacheData = NULL;
+	ModelInfo->CacheSize = 0;
 
 	tinyobj_attrib_t Attributes;
-	tinyobj_shape_t* Shapes;
-	size_t ShapeCount;
 	tinyobj_material_t* Materials;
 	size_t MaterialCount;
 
-	if (tinyobj_parse_obj(&Attributes, &Shapes, &ShapeCount, &Materials, &MaterialCount, ModelInfo->ModelPath, get_file_data, NULL, TINYOBJ_FLAG_TRIANGULATE) != TINYOBJ_SUCCESS)
+	if (parse_obj(&Attributes, &Materials, &MaterialCount, ModelInfo->ModelPath) != TINYOBJ_SUCCESS)
 	{
 		printf("Failed to read file '%s'\n", ModelInfo->ModelPath);
 		return;
 	}
 
-	size_t TotalVertices = Attributes.num_face_num_verts * 3;
-	float* Vertices = malloc(TotalVertices * OBJ_CHUNK_SIZE);
+	size_t FaceCount = Attributes.num_face_num_verts;
+	size_t TotalIndices = FaceCount * 3;
+	float* Vertices = malloc(TotalIndices * OBJ_CHUNK_SIZE);
+	unsigned int* Indices = malloc(TotalIndices * sizeof(unsigned int));
+	size_t* FaceCounts = calloc(MaterialCount + 1, sizeof(size_t)); // Last bucket holds faces without a material
+	size_t* FaceOrder = malloc(FaceCount * sizeof(size_t));
+	unsigned int* PositionIds = malloc(TotalIndices * sizeof(unsigned int)); // Which OBJ position each vertex came from
+	hashmap* VertexMap = hashmap_create();
 
-	if (!Vertices)
+	if (!Vertices || !Indices || !FaceCounts || !FaceOrder || !PositionIds || !VertexMap)
 	{
 		printf("Failed to allocate for file '%s'\n", ModelInfo->ModelPath);
 
+		free(Vertices);
+		free(Indices);
+		free(FaceCounts);
+		free(FaceOrder);
+		free(PositionIds);
+
+		if (VertexMap)
+			hashmap_free(VertexMap);
+
 		tinyobj_attrib_free(&Attributes);
-		tinyobj_shapes_free(Shapes, ShapeCount);
 		tinyobj_materials_free(Materials, MaterialCount);
 
 		return;
 	}
 
-	size_t Offset = 0;
+	// Counting sort the faces by material so each submesh is one contiguous index range
+	for (size_t Face = 0; Face < FaceCount; ++Face)
+		FaceCounts[get_material_bucket(Attributes.material_ids[Face], MaterialCount)]++;
+
+	size_t BucketStart = 0;
+
+	for (size_t i = 0; i <= MaterialCount; ++i)
+	{
+		size_t Count = FaceCounts[i];
+
+		FaceCounts[i] = BucketStart;
+		BucketStart += Count;
+	}
+
+	for (size_t Face = 0; Face < FaceCount; ++Face)
+		FaceOrder[FaceCounts[get_material_bucket(Attributes.material_ids[Face], MaterialCount)]++] = Face;
+
+	// FaceCounts now holds bucket ends, turn it back into counts
+	for (size_t i = MaterialCount; i > 0; --i)
+		FaceCounts[i] -= FaceCounts[i - 1];
 
-	for (size_t Face = 0; Face < Attributes.num_face_num_verts; Face++)
+	size_t VertexCount = 0;
+	bool MissingNormals = 0;
+
+	for (size_t Sorted = 0; Sorted < FaceCount; ++Sorted)
 	{
+		size_t Face = FaceOrder[Sorted];
 		int MaterialID = Attributes.material_ids[Face];
 		vec3 MaterialColor = { 1.f, 1.f, 1.f };
 
@@ -64,28 +297,86 @@ void load_obj(ModelInfo_t* ModelInfo)
 		for (int Vert = 0; Vert < 3; ++Vert)
 		{
 			tinyobj_vertex_index_t Index = Attributes.faces[(Face * 3) + Vert];
+			float* Vertex = &Vertices[VertexCount * OBJ_CHUNK_FLOATS];
 
-			// pos
-			Vertices[Offset++] = Attributes.vertices[(3 * Index.v_idx) + 0];
-			Vertices[Offset++] = Attributes.vertices[(3 * Index.v_idx) + 1];
-			Vertices[Offset++] = Attributes.vertices[(3 * Index.v_idx) + 2];
+			// Missing indices come out of tinyobj negative or past the end
+			if (Index.v_idx < 0 || (unsigned int)Index.v_idx >= Attributes.num_vertices)
+				Index.v_idx = 0;
 
-			// normal
-			Vertices[Offset++] = Attributes.normals[(3 * Index.vn_idx) + 0];
-			Vertices[Offset++] = Attributes.normals[(3 * Index.vn_idx) + 1];
-			Vertices[Offset++] = Attributes.normals[(3 * Index.vn_idx) + 2];
+			// pos
+			Vertex[0] = Attributes.vertices[(3 * Index.v_idx) + 0];
+			Vertex[1] = Attributes.vertices[(3 * Index.v_idx) + 1];
+			Vertex[2] = Attributes.vertices[(3 * Index.v_idx) + 2];
+
+			// normal, zero until generated when the file has none
+			if (Index.vn_idx >= 0 && (unsigned int)Index.vn_idx < Attributes.num_normals)
+			{
+				Vertex[3] = Attributes.normals[(3 * Index.vn_idx) + 0];
+				Vertex[4] = Attributes.normals[(3 * Index.vn_idx) + 1];
+				Vertex[5] = Attributes.normals[(3 * Index.vn_idx) + 2];
+			}
+			else
+			{
+				glm_vec3_zero(&Vertex[3]);
+				MissingNormals = 1;
+			}
 
 			// tex
-			Vertices[Offset++] = Attributes.texcoords[(2 * Index.vt_idx) + 0];
-			Vertices[Offset++] = Attributes.texcoords[(2 * Index.vt_idx) + 1];
+			if (Index.vt_idx >= 0 && (unsigned int)Index.vt_idx < Attributes.num_texcoords)
+			{
+				Vertex[6] = Attributes.texcoords[(2 * Index.vt_idx) + 0];
+				Vertex[7] = Attributes.texcoords[(2 * Index.vt_idx) + 1];
+			}
+			else
+			{
+				Vertex[6] = 0.f;
+				Vertex[7] = 0.f;
+			}
 
 			// material color
-			Vertices[Offset++] = MaterialColor[0];
-			Vertices[Offset++] = MaterialColor[1];
-			Vertices[Offset++] = MaterialColor[2];
+			Vertex[8] = MaterialColor[0];
+			Vertex[9] = MaterialColor[1];
+			Vertex[10] = MaterialColor[2];
+
+			// tangent, generated once the vertices are known
+			Vertex[11] = 0.f;
+			Vertex[12] = 0.f;
+			Vertex[13] = 0.f;
+			Vertex[14] = 0.f;
+
+			// The map keys point at the first copy of each vertex, which never moves since the array is sized for the worst case
+			uintptr_t VertexIndex = VertexCount;
+
+			if (hashmap_get_set(VertexMap, Vertex, OBJ_CHUNK_SIZE, &VertexIndex) != 1)
+			{
+				PositionIds[VertexCount] = (unsigned int)Index.v_idx;
+				VertexIndex = VertexCount++;
+			}
+
+			Indices[(Sorted * 3) + Vert] = (unsigned int)VertexIndex;
 		}
 	}
 
+	hashmap_free(VertexMap);
+	free(FaceOrder);
+
+	if (VertexCount > 0)
+	{
+		float* Shrunk = realloc(Vertices, VertexCount * OBJ_CHUNK_SIZE);
+
+		if (Shrunk)
+			Vertices = Shrunk;
+	}
+
+	// Smoothing goes by OBJ position so it carries across UV seams and material splits
+	if (MissingNormals && !generate_normals(Vertices, OBJ_CHUNK_FLOATS, VertexCount, Indices, TotalIndices, OBJ_NORMAL_OFFSET, PositionIds, Attributes.num_vertices))
+		printf("Failed to generate normals for file '%s'\n", ModelInfo->ModelPath);
+
+	free(PositionIds);
+
+	if (!generate_tangents(Vertices, OBJ_CHUNK_FLOATS, VertexCount, Indices, TotalIndices, OBJ_NORMAL_OFFSET, OBJ_TEXCOORD_OFFSET, OBJ_TANGENT_OFFSET))
+		printf("Failed to generate tangents for file '%s'\n", ModelInfo->ModelPath);
+
 	Material_t* OutMaterials = NULL;
 
 	if (MaterialCount > 0)
@@ -97,9 +388,10 @@ void load_obj(ModelInfo_t* ModelInfo)
 			printf("Failed to allocate materials for file '%s'\n", ModelInfo->ModelPath);
 
 			free(Vertices);
+			free(Indices);
+			free(FaceCounts);
 
 			tinyobj_attrib_free(&Attributes);
-			tinyobj_shapes_free(Shapes, ShapeCount);
 			tinyobj_materials_free(Materials, MaterialCount);
 
 			return;
@@ -125,22 +417,18 @@ void load_obj(ModelInfo_t* ModelInfo)
 		}
 	}
 
-	size_t* FaceCounts = calloc(MaterialCount, sizeof(size_t));
-
-	for (size_t Face = 0; Face < Attributes.num_face_num_verts; ++Face)
-	{
-		int MaterialID = Attributes.material_ids[Face];
-
-		if (MaterialID >= 0 && MaterialID < (int)MaterialCount)
-			FaceCounts[MaterialID]++;
-	}
-
 	size_t SubmeshCount = 0;
 
 	for (size_t i = 0; i < MaterialCount; ++i)
 		if (FaceCounts[i] > 0)
 			SubmeshCount++;
 
+	// Unassigned faces only need their own submesh when the rest of the model is split by material
+	bool HasUnassigned = SubmeshCount > 0 && FaceCounts[MaterialCount] > 0;
+
+	if (HasUnassigned)
+		SubmeshCount++;
+
 	Mesh_t* Submeshes = NULL;
 
 	if (SubmeshCount > 0)
@@ -152,26 +440,27 @@ void load_obj(ModelInfo_t* ModelInfo)
 			printf("Failed to allocate submeshes for file '%s'\n", ModelInfo->ModelPath);
 
 			free(Vertices);
+			free(Indices);
 			free(OutMaterials);
 			free(FaceCounts);
 
 			tinyobj_attrib_free(&Attributes);
-			tinyobj_shapes_free(Shapes, ShapeCount);
 			tinyobj_materials_free(Materials, MaterialCount);
 
 			return;
 		}
 
 		size_t Offset = 0;
+		size_t BucketCount = HasUnassigned ? MaterialCount + 1 : MaterialCount;
 
-		for (size_t i = 0; i < MaterialCount; ++i)
+		for (size_t i = 0; i < BucketCount; ++i)
 		{
 			if (FaceCounts[i] == 0)
 				continue;
 
-			Submeshes[ModelInfo->SubmeshCount].Index = Offset * 3;
-			Submeshes[ModelInfo->SubmeshCount].VertexCount = FaceCounts[i] * 3;
-			Submeshes[ModelInfo->SubmeshCount].Material = &OutMaterials[i];
+			Submeshes[ModelInfo->SubmeshCount].Lods[0].FirstIndex = Offset * 3;
+			Submeshes[ModelInfo->SubmeshCount].Lods[0].IndexCount = FaceCounts[i] * 3;
+			Submeshes[ModelInfo->SubmeshCount].Material = i < MaterialCount ? &OutMaterials[i] : NULL;
 
 			Offset += FaceCounts[i];
 			ModelInfo->SubmeshCount++;
@@ -180,61 +469,200 @@ void load_obj(ModelInfo_t* ModelInfo)
 
 	free(FaceCounts);
 
+	if (VertexCount > 0)
+	{
+		glm_vec3_copy(Vertices, ModelInfo->Mins);
+		glm_vec3_copy(Vertices, ModelInfo->Maxs);
+
+		for (size_t i = 1; i < VertexCount; ++i)
+		{
+			float* Position = &Vertices[i * OBJ_CHUNK_FLOATS];
+
+			glm_vec3_minv(ModelInfo->Mins, Position, ModelInfo->Mins);
+			glm_vec3_maxv(ModelInfo->Maxs, Position, ModelInfo->Maxs);
+		}
+	}
+
+	compute_bounding_sphere(Vertices, VertexCount, ModelInfo->SphereCenter, &ModelInfo->SphereRadius);
+
+	for (size_t i = 0; i < ModelInfo->SubmeshCount; ++i)
+		compute_index_bounds(Vertices, &Indices[Submeshes[i].Lods[0].FirstIndex], Submeshes[i].Lods[0].IndexCount, Submeshes[i].Mins, Submeshes[i].Maxs);
+
+	ModelInfo->Submeshes = Submeshes;
+	TotalIndices = build_model_lods(ModelInfo, Vertices, VertexCount, &Indices, TotalIndices);
+
 	tinyobj_attrib_free(&Attributes);
-	tinyobj_shapes_free(Shapes, ShapeCount);
 	tinyobj_materials_free(Materials, MaterialCount);
 
 	ModelInfo->Vertices = Vertices;
-	ModelInfo->VertexCount = TotalVertices;
+	ModelInfo->VertexCount = VertexCount;
+	ModelInfo->Indices = Indices;
+	ModelInfo->IndexCount = TotalIndices;
 	ModelInfo->MeshCount = 1;
 	ModelInfo->MaterialCount = MaterialCount;
 	ModelInfo->Materials = OutMaterials;
 	ModelInfo->Submeshes = Submeshes;
 }
 
-ModelInfo_t* ogt_get_model_info(const char* Path)
+void free_model_data(ModelInfo_t* ModelInfo)
 {
-	uintptr_t Existing;
+	if (ModelInfo->CacheData)
+		free_model_cache(ModelInfo);
+	else
+	{
+		free(ModelInfo->Vertices);
+		free(ModelInfo->Indices);
+	}
 
-	if (hashmap_get(GlobalVars->EntityManager->EntityModelMap, Path, strlen(Path), &Existing))
-		return (ModelInfo_t*)Existing;
+	for (size_t i = 0; i < ModelInfo->MaterialCount; ++i)
+		free(ModelInfo->Materials[i].TexturePath);
+
+	free(ModelInfo->Materials);
+	free(ModelInfo->Submeshes);
+
+	ModelInfo->Vertices = NULL;
+	ModelInfo->Indices = NULL;
+	ModelInfo->Materials = NULL;
+	ModelInfo->Submeshes = NULL;
+	ModelInfo->VertexCount = 0;
+	ModelInfo->IndexCount = 0;
+	ModelInfo->MaterialCount = 0;
+	ModelInfo->SubmeshCount = 0;
+	ModelInfo->LodCount = 0;
+}
+
+size_t get_vertex_size(VertexLayout_t Layout)
+{
+	return Layout == VERTEX_LAYOUT_COMPACT ? COMPACT_CHUNK_SIZE : OBJ_CHUNK_SIZE;
+}
+
+float get_model_radius(const ModelInfo_t* ModelInfo)
+{
+	return glm_vec3_distance((float*)ModelInfo->Mins, (float*)ModelInfo->Maxs) * .5f;
+}
+
+VertexLayout_t choose_vertex_layout(const ModelInfo_t* ModelInfo)
+{
+	if (!OGT_COMPACT_VERTICES)
+		return VERTEX_LAYOUT_FULL;
 
-		ModelInfo_t* ModelInfo = (ModelInfo_t*)malloc(sizeof(ModelInfo_t));
+	vec3 Extents;
+	glm_vec3_sub((float*)ModelInfo->Maxs, (float*)ModelInfo->Mins, Extents);
 
-	if (!ModelInfo)
+	if (glm_vec3_max(Extents) / (float)UINT16_MAX > COMPACT_MAX_POSITION_ERROR)
+		return VERTEX_LAYOUT_FULL;
+
+	for (size_t i = 0; i < ModelInfo->VertexCount; ++i)
 	{
-		printf("Failed to allocate model info for '%s'\n", Path);
+		const float* Vertex = &ModelInfo->Vertices[i * OBJ_CHUNK_FLOATS];
 
-		return NULL;
+		if (fabsf(Vertex[6]) > COMPACT_MAX_TEXCOORD || fabsf(Vertex[7]) > COMPACT_MAX_TEXCOORD)
+			return VERTEX_LAYOUT_FULL;
 	}
 
-	ModelInfo->ModelPath = Path;
-	ModelInfo->VAO = 0;
-	ModelInfo->VBO = 0;
+	return VERTEX_LAYOUT_COMPACT;
+}
 
-	load_obj(ModelInfo);
+static unsigned short quantize_unorm16(float Value, float Min, float Extent)
+{
+	if (Extent <= 0.f)
+		return 0;
 
-	if (ModelInfo->VertexCount <= 0)
+	return (unsigned short)(glm_clamp((Value - Min) / Extent, 0.f, 1.f) * UINT16_MAX + .5f);
+}
+
+static short quantize_snorm16(float Value)
+{
+	return (short)roundf(glm_clamp(Value, -1.f, 1.f) * INT16_MAX);
+}
+
+static void encode_octahedral(const float* Normal, short* Out)
+{
+	float Length = fabsf(Normal[0]) + fabsf(Normal[1]) + fabsf(Normal[2]);
+
+	if (Length <= 0.f)
 	{
-		printf("Failed to load model for '%s'\n", Path);
+		Out[0] = 0;
+		Out[1] = 0;
 
-		return NULL;
+		return;
 	}
 
-	for (size_t i = 0; i < ModelInfo->MaterialCount; ++i)
+	float X = Normal[0] / Length;
+	float Y = Normal[1] / Length;
+
+	if (Normal[2] < 0.f)
 	{
-		Material_t* Material = &ModelInfo->Materials[i];
+		float FoldedX = (1.f - fabsf(Y)) * (X >= 0.f ? 1.f : -1.f);
+		float FoldedY = (1.f - fabsf(X)) * (Y >= 0.f ? 1.f : -1.f);
 
-		if (Material->TexturePath)
-			Material->TextureID = create_texture(Material->TexturePath);
+		X = FoldedX;
+		Y = FoldedY;
 	}
 
-	glGenVertexArrays(1, &ModelInfo->VAO);
-	glGenBuffers(1, &ModelInfo->VBO);
+	Out[0] = quantize_snorm16(X);
+	Out[1] = quantize_snorm16(Y);
+}
+
+void* pack_vertices(const ModelInfo_t* ModelInfo, VertexLayout_t Layout)
+{
+	if (Layout == VERTEX_LAYOUT_FULL)
+		return ModelInfo->Vertices;
 
-	glBindVertexArray(ModelInfo->VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, ModelInfo->VBO);
-	glBufferData(GL_ARRAY_BUFFER, ModelInfo->VertexCount * OBJ_CHUNK_SIZE, ModelInfo->Vertices, GL_STATIC_DRAW);
+	unsigned short* Packed = malloc(ModelInfo->VertexCount * COMPACT_CHUNK_SIZE);
+
+	if (!Packed)
+		return NULL;
+
+	vec3 Extents;
+	glm_vec3_sub((float*)ModelInfo->Maxs, (float*)ModelInfo->Mins, Extents);
+
+	for (size_t i = 0; i < ModelInfo->VertexCount; ++i)
+	{
+		const float* In = &ModelInfo->Vertices[i * OBJ_CHUNK_FLOATS];
+		unsigned short* Out = &Packed[i * (COMPACT_CHUNK_SIZE / sizeof(unsigned short))];
+
+		// pos
+		Out[0] = quantize_unorm16(In[0], ModelInfo->Mins[0], Extents[0]);
+		Out[1] = quantize_unorm16(In[1], ModelInfo->Mins[1], Extents[1]);
+		Out[2] = quantize_unorm16(In[2], ModelInfo->Mins[2], Extents[2]);
+		Out[3] = In[14] < 0.f ? 0 : UINT16_MAX; // bitangent sign, read as the position's w
+
+		// normal
+		encode_octahedral(&In[3], (short*)&Out[4]);
+
+		// tex
+		Out[6] = float_to_half(In[6]);
+		Out[7] = float_to_half(In[7]);
+
+		// tangent
+		encode_octahedral(&In[11], (short*)&Out[8]);
+	}
+
+	return Packed;
+}
+
+void setup_vertex_attributes(VertexLayout_t Layout)
+{
+	if (Layout == VERTEX_LAYOUT_COMPACT)
+	{
+		glVertexAttribPointer(0, 4, GL_UNSIGNED_SHORT, GL_TRUE, COMPACT_CHUNK_SIZE, (void*)0);
+		glEnableVertexAttribArray(0);
+
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, COMPACT_CHUNK_SIZE, (void*)(4 * sizeof(unsigned short)));
+		glEnableVertexAttribArray(1);
+
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, COMPACT_CHUNK_SIZE, (void*)(6 * sizeof(unsigned short)));
+		glEnableVertexAttribArray(2);
+
+		// Material color comes from the current attribute value, set per submesh
+		glDisableVertexAttribArray(3);
+
+		glVertexAttribPointer(4, 2, GL_SHORT, GL_TRUE, COMPACT_CHUNK_SIZE, (void*)(8 * sizeof(unsigned short)));
+		glEnableVertexAttribArray(4);
+
+		return;
+	}
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, OBJ_CHUNK_SIZE, (void*)0);
 	glEnableVertexAttribArray(0);
@@ -248,18 +676,501 @@ ModelInfo_t* ogt_get_model_info(const char* Path)
 	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, OBJ_CHUNK_SIZE, (void*)(8 * sizeof(float)));
 	glEnableVertexAttribArray(3);
 
-	hashmap_set(GlobalVars->EntityManager->EntityModelMap, Path, strlen(Path), (uintptr_t)ModelInfo);
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, OBJ_CHUNK_SIZE, (void*)(OBJ_TANGENT_OFFSET * sizeof(float)));
+	glEnableVertexAttribArray(4);
+}
+
+static void* pack_indices(const ModelInfo_t* ModelInfo, size_t* IndexSize)
+{
+	if (ModelInfo->VertexCount <= UINT16_MAX + 1)
+	{
+		unsigned short* ShortIndices = malloc(ModelInfo->IndexCount * sizeof(unsigned short));
+
+		if (ShortIndices)
+		{
+			for (size_t i = 0; i < ModelInfo->IndexCount; ++i)
+				ShortIndices[i] = (unsigned short)ModelInfo->Indices[i];
+
+			*IndexSize = sizeof(unsigned short);
+
+			return ShortIndices;
+		}
+	}
+
+	*IndexSize = sizeof(unsigned int);
+
+	return ModelInfo->Indices;
+}
+
+static void free_model_upload(ModelUpload_t* Upload)
+{
+	ModelInfo_t* ModelInfo = Upload->ModelInfo;
+
+	if (Upload->VertexData != ModelInfo->Vertices)
+		free(Upload->VertexData);
+
+	if (Upload->IndexData != ModelInfo->Indices)
+		free(Upload->IndexData);
+
+	free(Upload->Textures);
+	free(Upload);
+}
+
+// Grows the ring on the main thread before a load starts, so finishing one never has to allocate on a worker
+static bool reserve_model_upload()
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+
+	lock_mutex(&Loader->Lock);
+
+	if (Loader->UploadCount + Loader->UploadsPending == Loader->UploadCapacity)
+	{
+		size_t Capacity = Loader->UploadCapacity > 0 ? Loader->UploadCapacity * 2 : 16;
+		ModelUpload_t** Uploads = malloc(Capacity * sizeof(ModelUpload_t*));
+
+		if (!Uploads)
+		{
+			unlock_mutex(&Loader->Lock);
+			return 0;
+		}
+
+		// Unwrapped so the oldest is first again
+		for (size_t i = 0; i < Loader->UploadCount; ++i)
+			Uploads[i] = Loader->Uploads[(Loader->UploadHead + i) % Loader->UploadCapacity];
+
+		free(Loader->Uploads);
+
+		Loader->Uploads = Uploads;
+		Loader->UploadCapacity = Capacity;
+		Loader->UploadHead = 0;
+	}
+
+	Loader->UploadsPending++;
+
+	unlock_mutex(&Loader->Lock);
+
+	return 1;
+}
+
+static void queue_model_upload(ModelUpload_t* Upload)
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+
+	lock_mutex(&Loader->Lock);
+
+	Loader->Uploads[(Loader->UploadHead + Loader->UploadCount) % Loader->UploadCapacity] = Upload;
+	Loader->UploadCount++;
+	Loader->UploadsPending--;
+
+	unlock_mutex(&Loader->Lock);
+}
+
+static ModelUpload_t* pop_model_upload()
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+	ModelUpload_t* Upload = NULL;
+
+	lock_mutex(&Loader->Lock);
+
+	if (Loader->UploadCount > 0)
+	{
+		Upload = Loader->Uploads[Loader->UploadHead];
+		Loader->UploadHead = (Loader->UploadHead + 1) % Loader->UploadCapacity;
+		Loader->UploadCount--;
+	}
+
+	unlock_mutex(&Loader->Lock);
+
+	return Upload;
+}
+
+static void load_model_job(void* Data)
+{
+	ModelUpload_t* Upload = (ModelUpload_t*)Data;
+	ModelInfo_t* ModelInfo = Upload->ModelInfo;
+
+	if (!load_model_cache(ModelInfo))
+	{
+		load_obj(ModelInfo);
+
+		if (ModelInfo->VertexCount > 0)
+			save_model_cache(ModelInfo);
+	}
+
+	if (ModelInfo->VertexCount <= 0)
+	{
+		Upload->Failed = 1;
+		queue_model_upload(Upload);
+
+		return;
+	}
+
+	JobCounter_t TextureCounter = { 0 };
+
+	if (ModelInfo->MaterialCount > 0)
+	{
+		Upload->Textures = calloc(ModelInfo->MaterialCount, sizeof(Texture_t*));
+
+		for (size_t i = 0; Upload->Textures && i < ModelInfo->MaterialCount; ++i)
+		{
+			Material_t* Material = &ModelInfo->Materials[i];
+			bool Owner;
+
+			if (!Material->TexturePath)
+				continue;
+
+			// Textures another load already owns show up once that load uploads them
+			Material->Texture = ogt_acquire_texture(Material->TexturePath, &Owner);
+
+			if (Material->Texture && Owner)
+				Upload->Textures[Upload->TextureCount++] = Material->Texture;
+		}
+
+		// Decodes alongside each other and the packing below
+		if (Upload->Textures)
+			ogt_decode_textures(Upload->Textures, Upload->TextureCount, &TextureCounter);
+	}
+
+	ModelInfo->VertexLayout = choose_vertex_layout(ModelInfo);
+	Upload->VertexData = pack_vertices(ModelInfo, ModelInfo->VertexLayout);
+
+	if (!Upload->VertexData)
+	{
+		printf("Failed to pack vertices for '%s', falling back to the full layout\n", ModelInfo->ModelPath);
+
+		ModelInfo->VertexLayout = VERTEX_LAYOUT_FULL;
+		Upload->VertexData = ModelInfo->Vertices;
+	}
+
+	Upload->IndexData = pack_indices(ModelInfo, &Upload->IndexSize);
+	analyze_vertex_cache(&ModelInfo->Indices[ModelInfo->Lods[0].FirstIndex], ModelInfo->Lods[0].IndexCount, ModelInfo->VertexCount, MESHOPT_CACHE_SIZE, &Upload->ACMR, &Upload->ATVR);
+	ModelInfo->IndexType = Upload->IndexSize == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	ogt_wait_for_jobs(&TextureCounter);
+	queue_model_upload(Upload);
+}
+
+// Does one texture or the mesh per call so a single big model can't blow the frame budget, returns 1 when finished
+static bool upload_model_step(ModelUpload_t* Upload)
+{
+	ModelInfo_t* ModelInfo = Upload->ModelInfo;
+
+	if (Upload->Failed)
+	{
+		printf("Failed to load model for '%s'\n", ModelInfo->ModelPath);
+
+		ModelInfo->State = MODEL_STATE_FAILED;
+
+		return 1;
+	}
+
+	ModelInfo->State = MODEL_STATE_UPLOADING;
+
+	if (Upload->NextTexture < Upload->TextureCount)
+	{
+		ogt_upload_texture(Upload->Textures[Upload->NextTexture++]);
+
+		return 0;
+	}
+
+	if (!ogt_alloc_model_geometry(ModelInfo, Upload->VertexData, Upload->IndexData, Upload->IndexSize))
+	{
+		printf("Failed to allocate geometry for '%s'\n", ModelInfo->ModelPath);
+
+		ModelInfo->State = MODEL_STATE_FAILED;
+
+		return 1;
+	}
+
+	ModelInfo->GpuSize += ModelInfo->VertexCount * get_vertex_size(ModelInfo->VertexLayout) + ModelInfo->IndexCount * Upload->IndexSize;
+	ModelInfo->State = MODEL_STATE_READY;
 
 	printf(
-		"Loaded Model for '%s' - Vertices: %d Size: %d Meshes: %d Materials: %d Submeshes: %d\n",
+		"Loaded Model for '%s' - Vertices: %zu Indices: %zu Layout: %s Size: %zu Meshes: %zu Materials: %zu Submeshes: %zu LODs: %zu ACMR: %.3f ATVR: %.3f\n",
 
-		Path,
+		ModelInfo->ModelPath,
 		ModelInfo->VertexCount,
-		ModelInfo->VertexCount * OBJ_CHUNK_SIZE,
+		ModelInfo->IndexCount,
+		ModelInfo->VertexLayout == VERTEX_LAYOUT_COMPACT ? "compact" : "full",
+		ModelInfo->VertexCount * get_vertex_size(ModelInfo->VertexLayout) + ModelInfo->IndexCount * Upload->IndexSize,
 		ModelInfo->MeshCount,
 		ModelInfo->MaterialCount,
-		ModelInfo->SubmeshCount
+		ModelInfo->SubmeshCount,
+		ModelInfo->LodCount,
+		Upload->ACMR,
+		Upload->ATVR
 	);
 
+	return 1;
+}
+
+void ogt_init_model_loader()
+{
+	GlobalVars->ModelLoader = (ModelLoader_t*)malloc(sizeof(ModelLoader_t));
+
+	if (!GlobalVars->ModelLoader)
+	{
+		printf("Failed to allocate for model loader!\n");
+		return;
+	}
+
+	init_mutex(&GlobalVars->ModelLoader->Lock);
+
+	GlobalVars->ModelLoader->Uploads = NULL;
+	GlobalVars->ModelLoader->UploadHead = 0;
+	GlobalVars->ModelLoader->UploadCount = 0;
+	GlobalVars->ModelLoader->UploadCapacity = 0;
+	GlobalVars->ModelLoader->UploadsPending = 0;
+	GlobalVars->ModelLoader->CurrentUpload = NULL;
+
+	GlobalVars->ModelLoader->Models = NULL;
+	GlobalVars->ModelLoader->ModelCount = 0;
+	GlobalVars->ModelLoader->ModelCapacity = 0;
+
+	GlobalVars->ModelLoader->CpuUsage = 0;
+	GlobalVars->ModelLoader->GpuUsage = 0;
+	GlobalVars->ModelLoader->CpuBudget = MODEL_CPU_BUDGET;
+	GlobalVars->ModelLoader->GpuBudget = MODEL_GPU_BUDGET;
+	GlobalVars->ModelLoader->ReleaseCpuData = MODEL_RELEASE_CPU_DATA;
+}
+
+static bool track_model(ModelInfo_t* ModelInfo)
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+
+	if (Loader->ModelCount == Loader->ModelCapacity)
+	{
+		size_t Capacity = Loader->ModelCapacity > 0 ? Loader->ModelCapacity * 2 : 16;
+		ModelInfo_t** Models = realloc(Loader->Models, Capacity * sizeof(ModelInfo_t*));
+
+		if (!Models)
+			return 0;
+
+		Loader->Models = Models;
+		Loader->ModelCapacity = Capacity;
+	}
+
+	Loader->Models[Loader->ModelCount++] = ModelInfo;
+
+	return 1;
+}
+
+// Vertices and Indices are only needed to build the GPU buffers, everything used for drawing and culling stays
+static void release_model_cpu_data(ModelInfo_t* ModelInfo)
+{
+	if (ModelInfo->CacheData)
+		free_model_cache(ModelInfo);
+	else
+	{
+		free(ModelInfo->Vertices);
+		free(ModelInfo->Indices);
+	}
+
+	ModelInfo->Vertices = NULL;
+	ModelInfo->Indices = NULL;
+}
+
+static void finish_model_load(ModelInfo_t* ModelInfo)
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+
+	if (ModelInfo->State == MODEL_STATE_READY && Loader->ReleaseCpuData)
+		release_model_cpu_data(ModelInfo);
+
+	ModelInfo->CpuSize = sizeof(ModelInfo_t) + ModelInfo->MaterialCount * sizeof(Material_t) + ModelInfo->SubmeshCount * sizeof(Mesh_t);
+
+	if (ModelInfo->CacheData)
+		ModelInfo->CpuSize += ModelInfo->CacheSize;
+	else if (ModelInfo->Vertices)
+		ModelInfo->CpuSize += ModelInfo->VertexCount * OBJ_CHUNK_SIZE + ModelInfo->IndexCount * sizeof(unsigned int);
+
+	Loader->CpuUsage += ModelInfo->CpuSize;
+	Loader->GpuUsage += ModelInfo->GpuSize;
+}
+
+static void destroy_model(ModelInfo_t* ModelInfo)
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+
+	hashmap_remove(GlobalVars->EntityManager->EntityModelMap, ModelInfo->ModelPath, strlen(ModelInfo->ModelPath));
+
+	for (size_t i = 0; i < Loader->ModelCount; ++i)
+	{
+		if (Loader->Models[i] == ModelInfo)
+		{
+			Loader->Models[i] = Loader->Models[--Loader->ModelCount];
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < ModelInfo->MaterialCount; ++i)
+		ogt_release_texture(ModelInfo->Materials[i].Texture);
+
+	ogt_free_model_geometry(ModelInfo);
+
+	Loader->CpuUsage -= ModelInfo->CpuSize;
+	Loader->GpuUsage -= ModelInfo->GpuSize;
+
+	free_model_data(ModelInfo);
+	free((char*)ModelInfo->ModelPath);
+	free(ModelInfo);
+}
+
+ModelInfo_t* ogt_get_model_info(const char* Path)
+{
+	uintptr_t Existing;
+
+	if (hashmap_get(GlobalVars->EntityManager->EntityModelMap, Path, strlen(Path), &Existing))
+	{
+		ModelInfo_t* ModelInfo = (ModelInfo_t*)Existing;
+		ModelInfo->RefCount++;
+
+		return ModelInfo;
+	}
+
+	ModelInfo_t* ModelInfo = (ModelInfo_t*)calloc(1, sizeof(ModelInfo_t));
+	ModelUpload_t* Upload = (ModelUpload_t*)calloc(1, sizeof(ModelUpload_t));
+	char* ModelPath = strdup(Path); // The map doesn't copy keys and eviction frees this
+
+	if (!ModelInfo || !Upload || !ModelPath || !track_model(ModelInfo))
+	{
+		printf("Failed to allocate model info for '%s'\n", Path);
+
+		free(ModelInfo);
+		free(Upload);
+		free(ModelPath);
+
+		return NULL;
+	}
+
+	ModelInfo->State = MODEL_STATE_LOADING;
+	ModelInfo->RefCount = 1;
+	ModelInfo->ModelPath = ModelPath;
+	ModelInfo->IndexType = GL_UNSIGNED_INT;
+	ModelInfo->VertexLayout = VERTEX_LAYOUT_FULL;
+
+	Upload->ModelInfo = ModelInfo;
+
+	// Registered up front so every entity asking for this path shares the one load
+	hashmap_set(GlobalVars->EntityManager->EntityModelMap, ModelPath, strlen(ModelPath), (uintptr_t)ModelInfo);
+
+	if (!reserve_model_upload())
+	{
+		printf("Failed to queue upload for '%s'\n", Path);
+
+		// Tracked and mapped already, eviction frees it like any other failed load
+		ModelInfo->State = MODEL_STATE_FAILED;
+		free(Upload);
+
+		return ModelInfo;
+	}
+
+	ogt_submit_job(load_model_job, Upload, NULL);
+
 	return ModelInfo;
 }
+
+void ogt_process_model_uploads(double Budget)
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+	double Deadline = glfwGetTime() + Budget;
+
+	// Always makes some progress, even with no budget left
+	do
+	{
+		if (!Loader->CurrentUpload)
+			Loader->CurrentUpload = pop_model_upload();
+
+		if (!Loader->CurrentUpload)
+			break;
+
+		if (upload_model_step(Loader->CurrentUpload))
+		{
+			ModelInfo_t* ModelInfo = Loader->CurrentUpload->ModelInfo;
+
+			// The upload may still point at the model's own vertices, so it goes first
+			free_model_upload(Loader->CurrentUpload);
+			Loader->CurrentUpload = NULL;
+
+			finish_model_load(ModelInfo);
+		}
+	} while (glfwGetTime() < Deadline);
+}
+
+void ogt_release_model(ModelInfo_t* ModelInfo)
+{
+	if (!ModelInfo || ModelInfo->RefCount == 0)
+		return;
+
+	if (--ModelInfo->RefCount == 0)
+		ModelInfo->LastUsed = glfwGetTime();
+}
+
+void ogt_set_model_budget(size_t CpuBudget, size_t GpuBudget)
+{
+	GlobalVars->ModelLoader->CpuBudget = CpuBudget;
+	GlobalVars->ModelLoader->GpuBudget = GpuBudget;
+}
+
+void ogt_evict_models()
+{
+	ModelLoader_t* Loader = GlobalVars->ModelLoader;
+
+	// Textures only go once every model using them has, so they count against the same budget
+	while (Loader->CpuUsage > Loader->CpuBudget || Loader->GpuUsage + GlobalVars->TextureCache->ResidentBytes > Loader->GpuBudget)
+	{
+		ModelInfo_t* Oldest = NULL;
+
+		for (size_t i = 0; i < Loader->ModelCount; ++i)
+		{
+			ModelInfo_t* ModelInfo = Loader->Models[i];
+
+			// Loading models are still owned by a worker or the upload queue
+			if (ModelInfo->RefCount > 0 || (ModelInfo->State != MODEL_STATE_READY && ModelInfo->State != MODEL_STATE_FAILED))
+				continue;
+
+			if (!Oldest || ModelInfo->LastUsed < Oldest->LastUsed)
+				Oldest = ModelInfo;
+		}
+
+		if (!Oldest)
+			break;
+
+		printf("Evicting model '%s' - CPU: %zu GPU: %zu\n", Oldest->ModelPath, Oldest->CpuSize, Oldest->GpuSize);
+
+		destroy_model(Oldest);
+	}
+}
+
+bool ogt_get_model_bounds(const ModelInfo_t* ModelInfo, vec3 Mins, vec3 Maxs)
+{
+	if (!ModelInfo || ModelInfo->State != MODEL_STATE_READY)
+		return 0;
+
+	glm_vec3_copy((float*)ModelInfo->Mins, Mins);
+	glm_vec3_copy((float*)ModelInfo->Maxs, Maxs);
+
+	return 1;
+}
+
+bool ogt_get_model_sphere(const ModelInfo_t* ModelInfo, vec3 Center, float* Radius)
+{
+	if (!ModelInfo || ModelInfo->State != MODEL_STATE_READY)
+		return 0;
+
+	glm_vec3_copy((float*)ModelInfo->SphereCenter, Center);
+	*Radius = ModelInfo->SphereRadius;
+
+	return 1;
+}
+
+bool ogt_get_submesh_bounds(const ModelInfo_t* ModelInfo, size_t Submesh, vec3 Mins, vec3 Maxs)
+{
+	if (!ModelInfo || ModelInfo->State != MODEL_STATE_READY || Submesh >= ModelInfo->SubmeshCount)
+		return 0;
+
+	glm_vec3_copy(ModelInfo->Submeshes[Submesh].Mins, Mins);
+	glm_vec3_copy(ModelInfo->Submeshes[Submesh].Maxs, Maxs);
+
+	return 1;
+}
@@ -4,11 +4,51 @@
 #include <cglm/types.h>
 #include <stddef.h>
 
-#define OBJ_CHUNK_SIZE (11 * sizeof(float)) // 3 pos, 3 normal, 2 tex, 3 material color
+#include "threads.h"
+#include "util.h"
+#include "textures.h"
+
+#define OBJ_CHUNK_SIZE (15 * sizeof(float)) // 3 pos, 3 normal, 2 tex, 3 material color, 4 tangent
+#define OBJ_CHUNK_FLOATS (OBJ_CHUNK_SIZE / sizeof(float))
+#define OBJ_NORMAL_OFFSET 3
+#define OBJ_TEXCOORD_OFFSET 6
+#define OBJ_TANGENT_OFFSET 11 // xyz + bitangent sign
+#define COMPACT_CHUNK_SIZE (10 * sizeof(unsigned short)) // 3 pos quantized to bounds + bitangent sign, 2 octahedral normal, 2 half tex, 2 octahedral tangent
+
+#define OGT_COMPACT_VERTICES 1 // Allow the compact layout, material color then comes from the submesh
+#define COMPACT_MAX_POSITION_ERROR 0.001f // Models whose 16 bit quantization step is coarser than this stay full
+#define COMPACT_MAX_TEXCOORD 2.f // Half floats lose sub-texel precision past this
+
+#define MODEL_MAX_LODS 4
+#define MODEL_LOD_REDUCTION 0.5f // Triangle ratio each LOD aims for relative to the previous one
+#define MODEL_LOD_MIN_REDUCTION 0.8f // A LOD that keeps more than this ratio isn't worth having, generation stops there
+#define MODEL_LOD_MAX_ERROR 0.05f // Furthest a LOD may move the surface, relative to the model radius
+#define MODEL_LOD_PIXEL_ERROR 1.f // Screen space error allowed before switching to a finer LOD
+#define MODEL_LOD_HYSTERESIS 0.25f // Fraction of the pixel error either side of a switch point that doesn't switch
+
+#define MODEL_UPLOAD_BUDGET 0.002 // Seconds per frame spent creating GL objects for finished loads
+#define MODEL_RELEASE_CPU_DATA 1 // Free vertices and indices once they're on the GPU, bounds and LODs are kept
+#define MODEL_CPU_BUDGET ((size_t)256 * 1024 * 1024) // Bytes all models may hold before unreferenced ones are evicted
+#define MODEL_GPU_BUDGET ((size_t)512 * 1024 * 1024)
+
+typedef enum
+{
+	VERTEX_LAYOUT_FULL,
+	VERTEX_LAYOUT_COMPACT,
+	VERTEX_LAYOUT_COUNT
+} VertexLayout_t;
+
+typedef enum
+{
+	MODEL_STATE_LOADING, // Parsing and decoding on a worker
+	MODEL_STATE_UPLOADING, // Waiting for the main thread to create its GL objects
+	MODEL_STATE_READY,
+	MODEL_STATE_FAILED
+} ModelState_t;
 
 typedef struct
 {
-	unsigned int TextureID;
+	Texture_t* Texture; // Shared through the texture cache, may still be loading for another model
 	char* TexturePath;
 	vec3 AmbientColor;
 	vec3 DiffuseColor;
@@ -20,28 +60,121 @@ typedef struct
 
 typedef struct
 {
-	size_t Index;
-	size_t VertexCount;
+	size_t FirstIndex;
+	size_t IndexCount;
+} MeshLod_t;
+
+typedef struct
+{
+	MeshLod_t Lods[MODEL_MAX_LODS]; // Only the first ModelInfo->LodCount are valid
 	Material_t* Material;
+
+	vec3 Mins; // Bounds of LOD 0 in model space
+	vec3 Maxs;
 } Mesh_t;
 
 typedef struct
 {
-	unsigned int VAO;
-	unsigned int VBO;
+	ModelState_t State; // Only touched on the main thread, nothing else is safe to read until READY
 
-	const char* ModelPath;
-	size_t VertexCount;
+	// Main thread only, unreferenced models stay cached until the budget needs their memory
+	unsigned int RefCount;
+	double LastUsed; // When the last reference was dropped
+	size_t CpuSize; // Counted once the model is READY or FAILED
+	size_t GpuSize;
+
+	// Where the model sits in its layout's geometry arena
+	bool HasGeometry;
+	size_t BaseVertex;
+	size_t IndexOffset; // Bytes
+	unsigned int IndexType; // GL_UNSIGNED_SHORT when every vertex fits, GL_UNSIGNED_INT otherwise
+	VertexLayout_t VertexLayout;
+
+	const char* ModelPath; // Owned by the loader when it came from ogt_get_model_info, also its EntityModelMap key
+	size_t VertexCount; // Unique vertices
+	size_t IndexCount; // Every LOD
 	size_t MeshCount;
 	size_t MaterialCount;
 	Material_t* Materials;
 	float* Vertices;
+	unsigned int* Indices;
 
 	Mesh_t* Submeshes;
 	size_t SubmeshCount;
+
+	// Indices hold each LOD in turn, every submesh's range for a LOD lies inside the model's range for it
+	MeshLod_t Lods[MODEL_MAX_LODS];
+	float LodErrors[MODEL_MAX_LODS]; // Relative to the model radius
+	size_t LodCount;
+
+	// Model space bounds, the box is tight and the sphere is close to it
+	vec3 Mins;
+	vec3 Maxs;
+	vec3 SphereCenter;
+	float SphereRadius;
+
+	void* CacheData; // Mapped baked model, Vertices and Indices point into this when loaded from the cache
+	size_t CacheSize;
 } ModelInfo_t;
 
+typedef struct
+{
+	ModelInfo_t* ModelInfo;
+	bool Failed;
+
+	void* VertexData; // Packed for the chosen layout, may point at ModelInfo->Vertices
+	void* IndexData; // Narrowed when possible, may point at ModelInfo->Indices
+	size_t IndexSize;
+
+	Texture_t** Textures; // The ones this load decoded and has to upload
+	size_t TextureCount;
+	size_t NextTexture;
+
+	float ACMR; // Vertex cache misses per triangle
+	float ATVR; // Vertex cache misses per unique vertex
+} ModelUpload_t;
+
+typedef struct
+{
+	Mutex_t Lock;
+
+	ModelUpload_t** Uploads; // Finished loads, ring buffer popped oldest first
+	size_t UploadHead;
+	size_t UploadCount;
+	size_t UploadCapacity;
+	size_t UploadsPending; // Loads still on a worker, each already has a slot waiting for it
+
+	ModelUpload_t* CurrentUpload; // Partially uploaded, main thread only
+
+	// Everything below is main thread only
+	ModelInfo_t** Models; // Every model in EntityModelMap
+	size_t ModelCount;
+	size_t ModelCapacity;
+
+	size_t CpuUsage;
+	size_t GpuUsage;
+	size_t CpuBudget;
+	size_t GpuBudget;
+	bool ReleaseCpuData; // Applies to models finishing after it's changed
+} ModelLoader_t;
+
 void load_obj(ModelInfo_t* ModelInfo);
-ModelInfo_t* ogt_get_model_info(const char* Path);
+void free_model_data(ModelInfo_t* ModelInfo);
+size_t get_vertex_size(VertexLayout_t Layout);
+VertexLayout_t choose_vertex_layout(const ModelInfo_t* ModelInfo);
+void* pack_vertices(const ModelInfo_t* ModelInfo, VertexLayout_t Layout);
+float get_model_radius(const ModelInfo_t* ModelInfo);
+void setup_vertex_attributes(VertexLayout_t Layout);
+void ogt_init_model_loader();
+ModelInfo_t* ogt_get_model_info(const char* Path); // Returns right away, the model loads in the background. Adds a reference
+void ogt_release_model(ModelInfo_t* ModelInfo);
+void ogt_process_model_uploads(double Budget);
+void ogt_set_model_budget(size_t CpuBudget, size_t GpuBudget);
+void ogt_evict_models(); // Frees the least recently used unreferenced models until usage fits the budget
+
+// These fail until the model is ready
+bool ogt_get_model_bounds(const ModelInfo_t* ModelInfo, vec3 Mins, vec3 Maxs);
+bool ogt_get_model_sphere(const ModelInfo_t* ModelInfo, vec3 Center, float* Radius);
+bool ogt_get_submesh_bounds(const ModelInfo_t* ModelInfo, size_t Submesh, vec3 Mins, vec3 Maxs);
 
 #endif
@@ -0,0 +1,320 @@
+#include "normals.h"
+
+#include <stdlib.h>
+#include <math.h>
+#include <cglm/cglm.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NORMALS_SSE 1
+#include <xmmintrin.h>
+#else
+#define NORMALS_SSE 0
+#endif
+
+#define NORMALS_BATCH 4 // Triangles per SIMD step
+
+typedef struct
+{
+	float X[NORMALS_BATCH];
+	float Y[NORMALS_BATCH];
+	float Z[NORMALS_BATCH];
+} FaceVectors_t;
+
+static void get_edges(const float* Vertices, size_t Stride, const unsigned int* Triangle, size_t Offset, size_t Components, float* E1, float* E2)
+{
+	const float* A = &Vertices[(Triangle[0] * Stride) + Offset];
+	const float* B = &Vertices[(Triangle[1] * Stride) + Offset];
+	const float* C = &Vertices[(Triangle[2] * Stride) + Offset];
+
+	for (size_t i = 0; i < Components; ++i)
+	{
+		E1[i] = B[i] - A[i];
+		E2[i] = C[i] - A[i];
+	}
+}
+
+// Cross product of the edges, its length is twice the area so summing these weights by area
+static void get_face_normal(const float* Vertices, size_t Stride, const unsigned int* Triangle, FaceVectors_t* Out, size_t Lane)
+{
+	vec3 E1, E2, Normal;
+	get_edges(Vertices, Stride, Triangle, 0, 3, E1, E2);
+	glm_vec3_cross(E1, E2, Normal);
+
+	Out->X[Lane] = Normal[0];
+	Out->Y[Lane] = Normal[1];
+	Out->Z[Lane] = Normal[2];
+}
+
+// Unit tangent and bitangent scaled by the face area, zero when the texcoords are degenerate
+static void get_face_tangent(const float* Vertices, size_t Stride, const unsigned int* Triangle, size_t TexCoordOffset, FaceVectors_t* Tangents, FaceVectors_t* Bitangents, size_t Lane)
+{
+	vec3 E1, E2, Normal;
+	vec2 UV1, UV2;
+
+	get_edges(Vertices, Stride, Triangle, 0, 3, E1, E2);
+	get_edges(Vertices, Stride, Triangle, TexCoordOffset, 2, UV1, UV2);
+	glm_vec3_cross(E1, E2, Normal);
+
+	float Det = (UV1[0] * UV2[1]) - (UV2[0] * UV1[1]);
+	float Area = glm_vec3_norm(Normal);
+
+	vec3 Tangent, Bitangent, Scaled;
+
+	glm_vec3_scale(E1, UV2[1], Tangent);
+	glm_vec3_scale(E2, UV1[1], Scaled);
+	glm_vec3_sub(Tangent, Scaled, Tangent);
+
+	glm_vec3_scale(E2, UV1[0], Bitangent);
+	glm_vec3_scale(E1, UV2[0], Scaled);
+	glm_vec3_sub(Bitangent, Scaled, Bitangent);
+
+	// Only the sign of 1 / Det matters once they're normalized
+	float TangentLength = glm_vec3_norm(Tangent);
+	float BitangentLength = glm_vec3_norm(Bitangent);
+	float Sign = Det < 0.f ? -1.f : 1.f;
+
+	float TangentScale = Det != 0.f && TangentLength > 0.f ? (Sign * Area) / TangentLength : 0.f;
+	float BitangentScale = Det != 0.f && BitangentLength > 0.f ? (Sign * Area) / BitangentLength : 0.f;
+
+	Tangents->X[Lane] = Tangent[0] * TangentScale;
+	Tangents->Y[Lane] = Tangent[1] * TangentScale;
+	Tangents->Z[Lane] = Tangent[2] * TangentScale;
+
+	Bitangents->X[Lane] = Bitangent[0] * BitangentScale;
+	Bitangents->Y[Lane] = Bitangent[1] * BitangentScale;
+	Bitangents->Z[Lane] = Bitangent[2] * BitangentScale;
+}
+
+#if NORMALS_SSE
+static inline __m128 gather_batch(const float* Vertices, size_t Stride, const unsigned int* Triangles, size_t Corner, size_t Offset)
+{
+	return _mm_setr_ps(
+		Vertices[(Triangles[Corner] * Stride) + Offset],
+		Vertices[(Triangles[3 + Corner] * Stride) + Offset],
+		Vertices[(Triangles[6 + Corner] * Stride) + Offset],
+		Vertices[(Triangles[9 + Corner] * Stride) + Offset]
+	);
+}
+
+// Edges of four triangles at once, one register per component
+static inline void get_batch_edges(const float* Vertices, size_t Stride, const unsigned int* Triangles, size_t Offset, size_t Components, __m128* E1, __m128* E2)
+{
+	for (size_t i = 0; i < Components; ++i)
+	{
+		__m128 A = gather_batch(Vertices, Stride, Triangles, 0, Offset + i);
+
+		E1[i] = _mm_sub_ps(gather_batch(Vertices, Stride, Triangles, 1, Offset + i), A);
+		E2[i] = _mm_sub_ps(gather_batch(Vertices, Stride, Triangles, 2, Offset + i), A);
+	}
+}
+
+static inline void cross_batch(const __m128* A, const __m128* B, __m128* Out)
+{
+	Out[0] = _mm_sub_ps(_mm_mul_ps(A[1], B[2]), _mm_mul_ps(A[2], B[1]));
+	Out[1] = _mm_sub_ps(_mm_mul_ps(A[2], B[0]), _mm_mul_ps(A[0], B[2]));
+	Out[2] = _mm_sub_ps(_mm_mul_ps(A[0], B[1]), _mm_mul_ps(A[1], B[0]));
+}
+
+static inline __m128 length_batch(const __m128* V)
+{
+	return _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(V[0], V[0]), _mm_mul_ps(V[1], V[1])), _mm_mul_ps(V[2], V[2])));
+}
+
+static void get_batch_normals(const float* Vertices, size_t Stride, const unsigned int* Triangles, FaceVectors_t* Out)
+{
+	__m128 E1[3], E2[3], Normal[3];
+	get_batch_edges(Vertices, Stride, Triangles, 0, 3, E1, E2);
+	cross_batch(E1, E2, Normal);
+
+	_mm_storeu_ps(Out->X, Normal[0]);
+	_mm_storeu_ps(Out->Y, Normal[1]);
+	_mm_storeu_ps(Out->Z, Normal[2]);
+}
+
+// Same as get_face_tangent, lanes that would divide by zero are masked out afterwards
+static void get_batch_tangents(const float* Vertices, size_t Stride, const unsigned int* Triangles, size_t TexCoordOffset, FaceVectors_t* Tangents, FaceVectors_t* Bitangents)
+{
+	__m128 E1[3], E2[3], UV1[2], UV2[2], Normal[3];
+	get_batch_edges(Vertices, Stride, Triangles, 0, 3, E1, E2);
+	get_batch_edges(Vertices, Stride, Triangles, TexCoordOffset, 2, UV1, UV2);
+	cross_batch(E1, E2, Normal);
+
+	__m128 Zero = _mm_setzero_ps();
+	__m128 Det = _mm_sub_ps(_mm_mul_ps(UV1[0], UV2[1]), _mm_mul_ps(UV2[0], UV1[1]));
+	__m128 Area = length_batch(Normal);
+
+	__m128 Tangent[3], Bitangent[3];
+
+	for (int i = 0; i < 3; ++i)
+	{
+		Tangent[i] = _mm_sub_ps(_mm_mul_ps(E1[i], UV2[1]), _mm_mul_ps(E2[i], UV1[1]));
+		Bitangent[i] = _mm_sub_ps(_mm_mul_ps(E2[i], UV1[0]), _mm_mul_ps(E1[i], UV2[0]));
+	}
+
+	__m128 TangentLength = length_batch(Tangent);
+	__m128 BitangentLength = length_batch(Bitangent);
+
+	// Flip the area's sign to match Det's
+	__m128 SignedArea = _mm_or_ps(Area, _mm_and_ps(Det, _mm_set1_ps(-0.f)));
+	__m128 Valid = _mm_cmpneq_ps(Det, Zero);
+
+	__m128 TangentScale = _mm_and_ps(_mm_div_ps(SignedArea, TangentLength), _mm_and_ps(Valid, _mm_cmpgt_ps(TangentLength, Zero)));
+	__m128 BitangentScale = _mm_and_ps(_mm_div_ps(SignedArea, BitangentLength), _mm_and_ps(Valid, _mm_cmpgt_ps(BitangentLength, Zero)));
+
+	_mm_storeu_ps(Tangents->X, _mm_mul_ps(Tangent[0], TangentScale));
+	_mm_storeu_ps(Tangents->Y, _mm_mul_ps(Tangent[1], TangentScale));
+	_mm_storeu_ps(Tangents->Z, _mm_mul_ps(Tangent[2], TangentScale));
+
+	_mm_storeu_ps(Bitangents->X, _mm_mul_ps(Bitangent[0], BitangentScale));
+	_mm_storeu_ps(Bitangents->Y, _mm_mul_ps(Bitangent[1], BitangentScale));
+	_mm_storeu_ps(Bitangents->Z, _mm_mul_ps(Bitangent[2], BitangentScale));
+}
+#endif
+
+static void accumulate(float* Sums, size_t Slot, const FaceVectors_t* Vectors, size_t Lane)
+{
+	Sums[(Slot * 3) + 0] += Vectors->X[Lane];
+	Sums[(Slot * 3) + 1] += Vectors->Y[Lane];
+	Sums[(Slot * 3) + 2] += Vectors->Z[Lane];
+}
+
+bool generate_normals(float* Vertices, size_t Stride, size_t VertexCount, const unsigned int* Indices, size_t IndexCount, size_t NormalOffset, const unsigned int* Groups, size_t GroupCount)
+{
+	if (!Groups)
+		GroupCount = VertexCount;
+
+	float* Sums = calloc(GroupCount * 3, sizeof(float));
+
+	if (!Sums)
+		return 0;
+
+	size_t TriangleCount = IndexCount / 3;
+	FaceVectors_t Normals;
+
+	for (size_t Triangle = 0; Triangle < TriangleCount; Triangle += NORMALS_BATCH)
+	{
+		const unsigned int* Batch = &Indices[Triangle * 3];
+		size_t Lanes = TriangleCount - Triangle < NORMALS_BATCH ? TriangleCount - Triangle : NORMALS_BATCH;
+
+#if NORMALS_SSE
+		if (Lanes == NORMALS_BATCH)
+			get_batch_normals(Vertices, Stride, Batch, &Normals);
+		else
+#endif
+		for (size_t Lane = 0; Lane < Lanes; ++Lane)
+			get_face_normal(Vertices, Stride, &Batch[Lane * 3], &Normals, Lane);
+
+		for (size_t Lane = 0; Lane < Lanes; ++Lane)
+		{
+			for (size_t Corner = 0; Corner < 3; ++Corner)
+			{
+				unsigned int Vertex = Batch[(Lane * 3) + Corner];
+
+				accumulate(Sums, Groups ? Groups[Vertex] : Vertex, &Normals, Lane);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < VertexCount; ++i)
+	{
+		float* Normal = &Vertices[(i * Stride) + NormalOffset];
+
+		// Only fill in what the file left out
+		if (Normal[0] != 0.f || Normal[1] != 0.f || Normal[2] != 0.f)
+			continue;
+
+		float* Sum = &Sums[(Groups ? Groups[i] : i) * 3];
+		float Length = glm_vec3_norm(Sum);
+
+		if (Length > 0.f)
+			glm_vec3_scale(Sum, 1.f / Length, Normal);
+		else
+			glm_vec3_copy((vec3){ 0.f, 1.f, 0.f }, Normal); // Unused or degenerate, anything unit length will do
+	}
+
+	free(Sums);
+
+	return 1;
+}
+
+bool generate_tangents(float* Vertices, size_t Stride, size_t VertexCount, const unsigned int* Indices, size_t IndexCount, size_t NormalOffset, size_t TexCoordOffset, size_t TangentOffset)
+{
+	float* TangentSums = calloc(VertexCount * 3, sizeof(float));
+	float* BitangentSums = calloc(VertexCount * 3, sizeof(float));
+
+	if (!TangentSums || !BitangentSums)
+	{
+		free(TangentSums);
+		free(BitangentSums);
+
+		return 0;
+	}
+
+	size_t TriangleCount = IndexCount / 3;
+	FaceVectors_t Tangents, Bitangents;
+
+	for (size_t Triangle = 0; Triangle < TriangleCount; Triangle += NORMALS_BATCH)
+	{
+		const unsigned int* Batch = &Indices[Triangle * 3];
+		size_t Lanes = TriangleCount - Triangle < NORMALS_BATCH ? TriangleCount - Triangle : NORMALS_BATCH;
+
+#if NORMALS_SSE
+		if (Lanes == NORMALS_BATCH)
+			get_batch_tangents(Vertices, Stride, Batch, TexCoordOffset, &Tangents, &Bitangents);
+		else
+#endif
+		for (size_t Lane = 0; Lane < Lanes; ++Lane)
+			get_face_tangent(Vertices, Stride, &Batch[Lane * 3], TexCoordOffset, &Tangents, &Bitangents, Lane);
+
+		for (size_t Lane = 0; Lane < Lanes; ++Lane)
+		{
+			for (size_t Corner = 0; Corner < 3; ++Corner)
+			{
+				unsigned int Vertex = Batch[(Lane * 3) + Corner];
+
+				accumulate(TangentSums, Vertex, &Tangents, Lane);
+				accumulate(BitangentSums, Vertex, &Bitangents, Lane);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < VertexCount; ++i)
+	{
+		float* Vertex = &Vertices[i * Stride];
+		float* Tangent = &Vertex[TangentOffset];
+		float* Sum = &TangentSums[i * 3];
+
+		vec3 Normal;
+		glm_vec3_normalize_to(&Vertex[NormalOffset], Normal);
+
+		// Gram-Schmidt against the normal
+		vec3 Projected;
+		glm_vec3_scale(Normal, glm_vec3_dot(Normal, Sum), Projected);
+		glm_vec3_sub(Sum, Projected, Tangent);
+
+		float Length = glm_vec3_norm(Tangent);
+
+		if (Length > 1e-6f)
+			glm_vec3_scale(Tangent, 1.f / Length, Tangent);
+		else
+		{
+			// No usable texcoords, any direction in the surface keeps the basis valid
+			vec3 Axis = { 1.f, 0.f, 0.f };
+
+			if (fabsf(Normal[0]) > .9f)
+				glm_vec3_copy((vec3){ 0.f, 1.f, 0.f }, Axis);
+
+			glm_vec3_crossn(Normal, Axis, Tangent);
+		}
+
+		vec3 Bitangent;
+		glm_vec3_cross(Normal, Tangent, Bitangent);
+
+		Tangent[3] = glm_vec3_dot(Bitangent, &BitangentSums[i * 3]) < 0.f ? -1.f : 1.f;
+	}
+
+	free(TangentSums);
+	free(BitangentSums);
+
+	return 1;
+}
@@ -0,0 +1,17 @@
+#ifndef ogt_normals
+#define ogt_normals
+
+#include <stddef.h>
+
+// Vertices start with a position, attributes sit at the given float offsets into every Stride floats.
+// Both return 0 when they can't allocate, leaving the vertices untouched.
+
+// Area weighted smooth normals for vertices whose normal is zero. Groups maps every vertex to the position it
+// shares with others so smoothing crosses UV seams, pass NULL to treat every vertex on its own.
+bool generate_normals(float* Vertices, size_t Stride, size_t VertexCount, const unsigned int* Indices, size_t IndexCount, size_t NormalOffset, const unsigned int* Groups, size_t GroupCount);
+
+// Tangents in the MikkTSpace convention, xyz is orthogonal to the normal and w is the sign to give
+// bitangent = w * cross(normal, tangent). Vertices without usable texcoords get any perpendicular tangent.
+bool generate_tangents(float* Vertices, size_t Stride, size_t VertexCount, const unsigned int* Indices, size_t IndexCount, size_t NormalOffset, size_t TexCoordOffset, size_t TangentOffset);
+
+#endif
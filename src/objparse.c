@@ -0,0 +1,569 @@
+#include "objparse.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TINYOBJ_LOADER_C_IMPLEMENTATION
+#include <tinyobj_loader_c.h>
+
+#include "globals.h"
+#include "util.h"
+#include "jobs.h"
+
+#define OBJ_RELATIVE_V (1 << 0)
+#define OBJ_RELATIVE_VT (1 << 1)
+#define OBJ_RELATIVE_VN (1 << 2)
+
+typedef struct
+{
+	size_t Face; // Local index of the first face using this material
+	const char* Name;
+	unsigned int NameLength;
+	int Material;
+} ObjMaterialSwitch_t;
+
+typedef struct
+{
+	const char* Data;
+	size_t FileSize;
+	size_t Begin;
+	size_t End;
+
+	float* Vertices;
+	size_t VertexCount;
+	size_t VertexCapacity;
+
+	float* Normals;
+	size_t NormalCount;
+	size_t NormalCapacity;
+
+	float* Texcoords;
+	size_t TexcoordCount;
+	size_t TexcoordCapacity;
+
+	// Negative OBJ indices are stored relative to the chunk and flagged, they're fixed up once the chunk offsets are known
+	tinyobj_vertex_index_t* Faces;
+	unsigned char* Relative;
+	size_t FaceVertexCount;
+	size_t FaceVertexCapacity;
+
+	int* FaceNumVerts;
+	size_t FaceCount;
+	size_t FaceCapacity;
+
+	ObjMaterialSwitch_t* MaterialSwitches;
+	size_t MaterialSwitchCount;
+	size_t MaterialSwitchCapacity;
+
+	const char* MtlLib;
+	unsigned int MtlLibLength;
+
+	// Filled in between the parse and merge passes
+	size_t VertexOffset;
+	size_t NormalOffset;
+	size_t TexcoordOffset;
+	size_t FaceVertexOffset;
+	size_t FaceOffset;
+	int StartMaterial;
+	tinyobj_attrib_t* Out;
+
+	bool Failed;
+} ObjChunk_t;
+
+static void get_file_data(void* _, const char* Path, const int IsMaterial, const char* OBJPath, char** Data, size_t* Length)
+{
+	read_file(Path, Data, Length);
+}
+
+static bool reserve_array(void** Array, size_t* Capacity, size_t Count, size_t ElementSize)
+{
+	if (Count <= *Capacity)
+		return 1;
+
+	size_t NewCapacity = *Capacity > 0 ? *Capacity * 2 : 1024;
+
+	while (NewCapacity < Count)
+		NewCapacity *= 2;
+
+	void* NewArray = realloc(*Array, NewCapacity * ElementSize);
+
+	if (!NewArray)
+		return 0;
+
+	*Array = NewArray;
+	*Capacity = NewCapacity;
+
+	return 1;
+}
+
+static int resolve_chunk_index(int Index, size_t LocalCount, unsigned char* Relative, unsigned char Flag)
+{
+	if (Index > 0)
+		return Index - 1;
+
+	if (Index == 0)
+		return 0;
+
+	// Relative, also covers missing indices which tinyobj turns into count + INT_MIN
+	*Relative |= Flag;
+
+	return (int)LocalCount + Index;
+}
+
+static bool parse_chunk_line(ObjChunk_t* Chunk, const char* Line, size_t Length)
+{
+	Command Command;
+
+	if (!parseLine(&Command, Line, Length, 1))
+		return 1;
+
+	switch (Command.type)
+	{
+		case COMMAND_V:
+			if (!reserve_array((void**)&Chunk->Vertices, &Chunk->VertexCapacity, (Chunk->VertexCount + 1) * 3, sizeof(float)))
+				return 0;
+
+			Chunk->Vertices[(Chunk->VertexCount * 3) + 0] = Command.vx;
+			Chunk->Vertices[(Chunk->VertexCount * 3) + 1] = Command.vy;
+			Chunk->Vertices[(Chunk->VertexCount * 3) + 2] = Command.vz;
+			Chunk->VertexCount++;
+			break;
+
+		case COMMAND_VN:
+			if (!reserve_array((void**)&Chunk->Normals, &Chunk->NormalCapacity, (Chunk->NormalCount + 1) * 3, sizeof(float)))
+				return 0;
+
+			Chunk->Normals[(Chunk->NormalCount * 3) + 0] = Command.nx;
+			Chunk->Normals[(Chunk->NormalCount * 3) + 1] = Command.ny;
+			Chunk->Normals[(Chunk->NormalCount * 3) + 2] = Command.nz;
+			Chunk->NormalCount++;
+			break;
+
+		case COMMAND_VT:
+			if (!reserve_array((void**)&Chunk->Texcoords, &Chunk->TexcoordCapacity, (Chunk->TexcoordCount + 1) * 2, sizeof(float)))
+				return 0;
+
+			Chunk->Texcoords[(Chunk->TexcoordCount * 2) + 0] = Command.tx;
+			Chunk->Texcoords[(Chunk->TexcoordCount * 2) + 1] = Command.ty;
+			Chunk->TexcoordCount++;
+			break;
+
+		case COMMAND_F:
+		{
+			size_t FaceVertexCount = Chunk->FaceVertexCount + Command.num_f;
+			size_t FaceCapacity = Chunk->FaceVertexCapacity;
+
+			if (
+				!reserve_array((void**)&Chunk->Faces, &Chunk->FaceVertexCapacity, FaceVertexCount, sizeof(tinyobj_vertex_index_t))
+				|| !reserve_array((void**)&Chunk->Relative, &FaceCapacity, FaceVertexCount, sizeof(unsigned char))
+				|| !reserve_array((void**)&Chunk->FaceNumVerts, &Chunk->FaceCapacity, Chunk->FaceCount + Command.num_f_num_verts, sizeof(int))
+			)
+				return 0;
+
+			for (size_t k = 0; k < Command.num_f; ++k)
+			{
+				tinyobj_vertex_index_t In = Command.f[k];
+				tinyobj_vertex_index_t* Out = &Chunk->Faces[Chunk->FaceVertexCount + k];
+				unsigned char Relative = 0;
+
+				Out->v_idx = resolve_chunk_index(In.v_idx, Chunk->VertexCount, &Relative, OBJ_RELATIVE_V);
+				Out->vt_idx = resolve_chunk_index(In.vt_idx, Chunk->TexcoordCount, &Relative, OBJ_RELATIVE_VT);
+				Out->vn_idx = resolve_chunk_index(In.vn_idx, Chunk->NormalCount, &Relative, OBJ_RELATIVE_VN);
+
+				Chunk->Relative[Chunk->FaceVertexCount + k] = Relative;
+			}
+
+			for (size_t k = 0; k < Command.num_f_num_verts; ++k)
+				Chunk->FaceNumVerts[Chunk->FaceCount + k] = Command.f_num_verts[k];
+
+			Chunk->FaceVertexCount = FaceVertexCount;
+			Chunk->FaceCount += Command.num_f_num_verts;
+			break;
+		}
+
+		case COMMAND_USEMTL:
+			if (!Command.material_name || Command.material_name_len == 0)
+				break;
+
+			if (!reserve_array((void**)&Chunk->MaterialSwitches, &Chunk->MaterialSwitchCapacity, Chunk->MaterialSwitchCount + 1, sizeof(ObjMaterialSwitch_t)))
+				return 0;
+
+			Chunk->MaterialSwitches[Chunk->MaterialSwitchCount].Face = Chunk->FaceCount;
+			Chunk->MaterialSwitches[Chunk->MaterialSwitchCount].Name = Command.material_name;
+			Chunk->MaterialSwitches[Chunk->MaterialSwitchCount].NameLength = Command.material_name_len;
+			Chunk->MaterialSwitches[Chunk->MaterialSwitchCount].Material = -1;
+			Chunk->MaterialSwitchCount++;
+			break;
+
+		case COMMAND_MTLLIB:
+			Chunk->MtlLib = Command.mtllib_name;
+			Chunk->MtlLibLength = Command.mtllib_name_len;
+			break;
+
+		default:
+			break;
+	}
+
+	return 1;
+}
+
+static void parse_chunk(void* Data)
+{
+	ObjChunk_t* Chunk = (ObjChunk_t*)Data;
+	size_t LineStart = Chunk->Begin;
+
+	// Chunks start right after a '\n', so line endings are found exactly like tinyobj's get_line_infos
+	for (size_t i = Chunk->Begin; i <= Chunk->End; ++i)
+	{
+		if (i < Chunk->End && !is_line_ending(Chunk->Data, i, Chunk->FileSize))
+			continue;
+
+		if (i > LineStart && !parse_chunk_line(Chunk, &Chunk->Data[LineStart], i - LineStart))
+		{
+			Chunk->Failed = 1;
+			return;
+		}
+
+		LineStart = i + 1;
+	}
+}
+
+static void merge_chunk(void* Data)
+{
+	ObjChunk_t* Chunk = (ObjChunk_t*)Data;
+	tinyobj_attrib_t* Out = Chunk->Out;
+
+	if (Chunk->VertexCount > 0)
+		memcpy(&Out->vertices[Chunk->VertexOffset * 3], Chunk->Vertices, Chunk->VertexCount * 3 * sizeof(float));
+
+	if (Chunk->NormalCount > 0)
+		memcpy(&Out->normals[Chunk->NormalOffset * 3], Chunk->Normals, Chunk->NormalCount * 3 * sizeof(float));
+
+	if (Chunk->TexcoordCount > 0)
+		memcpy(&Out->texcoords[Chunk->TexcoordOffset * 2], Chunk->Texcoords, Chunk->TexcoordCount * 2 * sizeof(float));
+
+	for (size_t i = 0; i < Chunk->FaceVertexCount; ++i)
+	{
+		tinyobj_vertex_index_t Index = Chunk->Faces[i];
+		unsigned char Relative = Chunk->Relative[i];
+
+		if (Relative & OBJ_RELATIVE_V)
+			Index.v_idx += (int)Chunk->VertexOffset;
+
+		if (Relative & OBJ_RELATIVE_VT)
+			Index.vt_idx += (int)Chunk->TexcoordOffset;
+
+		if (Relative & OBJ_RELATIVE_VN)
+			Index.vn_idx += (int)Chunk->NormalOffset;
+
+		Out->faces[Chunk->FaceVertexOffset + i] = Index;
+	}
+
+	if (Chunk->FaceCount > 0)
+		memcpy(&Out->face_num_verts[Chunk->FaceOffset], Chunk->FaceNumVerts, Chunk->FaceCount * sizeof(int));
+
+	int Material = Chunk->StartMaterial;
+	size_t Switch = 0;
+
+	for (size_t i = 0; i < Chunk->FaceCount; ++i)
+	{
+		while (Switch < Chunk->MaterialSwitchCount && Chunk->MaterialSwitches[Switch].Face == i)
+			Material = Chunk->MaterialSwitches[Switch++].Material;
+
+		Out->material_ids[Chunk->FaceOffset + i] = Material;
+	}
+}
+
+static void free_chunk(ObjChunk_t* Chunk)
+{
+	free(Chunk->Vertices);
+	free(Chunk->Normals);
+	free(Chunk->Texcoords);
+	free(Chunk->Faces);
+	free(Chunk->Relative);
+	free(Chunk->FaceNumVerts);
+	free(Chunk->MaterialSwitches);
+}
+
+static int find_material(const ObjMaterialSwitch_t* Switch, hash_table_t* MaterialTable)
+{
+	char* Name = malloc(Switch->NameLength + 1);
+
+	if (!Name)
+		return -1;
+
+	memcpy(Name, Switch->Name, Switch->NameLength);
+	Name[Switch->NameLength] = '\0';
+
+	int Material = hash_table_exists(Name, MaterialTable) ? (int)hash_table_get(Name, MaterialTable) : -1;
+
+	free(Name);
+
+	return Material;
+}
+
+static void load_mtllib(const char* Path, const char* MtlLib, unsigned int MtlLibLength, tinyobj_material_t** Materials, size_t* MaterialCount, hash_table_t* MaterialTable)
+{
+	// Mirrors the mtllib handling in tinyobj_parse_obj
+	size_t PathLength = my_strnlen(Path, 4096 + 255) + 1;
+	size_t NameLength = length_until_line_feed(MtlLib, MtlLibLength);
+	char* Name = my_strndup(MtlLib, NameLength);
+	char* MtlPath = generate_mtl_filename(Path, PathLength, Name, NameLength + 1);
+
+	int Result = tinyobj_parse_and_index_mtl_file(Materials, MaterialCount, MtlPath, Path, get_file_data, NULL, MaterialTable);
+
+	if (Result != TINYOBJ_SUCCESS)
+		printf("Failed to parse material file '%s': %d\n", MtlPath, Result);
+
+	free(MtlPath);
+	free(Name);
+}
+
+int parse_obj_parallel(tinyobj_attrib_t* Attributes, tinyobj_material_t** Materials, size_t* MaterialCount, const char* Path, const char* Data, size_t Size)
+{
+	*Materials = NULL;
+	*MaterialCount = 0;
+
+	if (!Data || Size < 1)
+		return TINYOBJ_ERROR_INVALID_PARAMETER;
+
+	tinyobj_attrib_init(Attributes);
+
+	size_t MaxChunks = (size_t)(ogt_get_worker_count() + 1) * OBJ_CHUNKS_PER_THREAD;
+	size_t ChunkCount = Size / OBJ_MIN_CHUNK_SIZE;
+
+	if (ChunkCount > MaxChunks)
+		ChunkCount = MaxChunks;
+
+	if (ChunkCount < 1)
+		ChunkCount = 1;
+
+	ObjChunk_t* Chunks = calloc(ChunkCount, sizeof(ObjChunk_t));
+
+	if (!Chunks)
+		return TINYOBJ_ERROR_EMPTY;
+
+	size_t Begin = 0;
+
+	for (size_t i = 0; i < ChunkCount; ++i)
+	{
+		size_t End = Size;
+
+		if (i + 1 < ChunkCount)
+		{
+			End = Size / ChunkCount * (i + 1);
+
+			if (End < Begin)
+				End = Begin;
+
+			while (End < Size && Data[End] != '\n')
+				End++;
+
+			if (End < Size)
+				End++;
+		}
+
+		Chunks[i].Data = Data;
+		Chunks[i].FileSize = Size;
+		Chunks[i].Begin = Begin;
+		Chunks[i].End = End;
+
+		Begin = End;
+	}
+
+	JobCounter_t Counter = { 0 };
+
+	for (size_t i = 0; i < ChunkCount; ++i)
+		ogt_submit_job(parse_chunk, &Chunks[i], &Counter);
+
+	ogt_wait_for_jobs(&Counter);
+
+	// Prefix sums give every chunk its place in the final arrays
+	size_t VertexCount = 0, NormalCount = 0, TexcoordCount = 0, FaceVertexCount = 0, FaceCount = 0;
+	const char* MtlLib = NULL;
+	unsigned int MtlLibLength = 0;
+	bool Failed = 0;
+
+	for (size_t i = 0; i < ChunkCount; ++i)
+	{
+		ObjChunk_t* Chunk = &Chunks[i];
+
+		Failed |= Chunk->Failed;
+
+		Chunk->VertexOffset = VertexCount;
+		Chunk->NormalOffset = NormalCount;
+		Chunk->TexcoordOffset = TexcoordCount;
+		Chunk->FaceVertexOffset = FaceVertexCount;
+		Chunk->FaceOffset = FaceCount;
+
+		VertexCount += Chunk->VertexCount;
+		NormalCount += Chunk->NormalCount;
+		TexcoordCount += Chunk->TexcoordCount;
+		FaceVertexCount += Chunk->FaceVertexCount;
+		FaceCount += Chunk->FaceCount;
+
+		if (Chunk->MtlLib && Chunk->MtlLibLength > 0)
+		{
+			MtlLib = Chunk->MtlLib;
+			MtlLibLength = Chunk->MtlLibLength;
+		}
+	}
+
+	if (!Failed)
+	{
+		Attributes->vertices = (float*)TINYOBJ_MALLOC(sizeof(float) * VertexCount * 3);
+		Attributes->num_vertices = (unsigned int)VertexCount;
+		Attributes->normals = (float*)TINYOBJ_MALLOC(sizeof(float) * NormalCount * 3);
+		Attributes->num_normals = (unsigned int)NormalCount;
+		Attributes->texcoords = (float*)TINYOBJ_MALLOC(sizeof(float) * TexcoordCount * 2);
+		Attributes->num_texcoords = (unsigned int)TexcoordCount;
+		Attributes->faces = (tinyobj_vertex_index_t*)TINYOBJ_MALLOC(sizeof(tinyobj_vertex_index_t) * FaceVertexCount);
+		Attributes->num_faces = (unsigned int)FaceVertexCount;
+		Attributes->face_num_verts = (int*)TINYOBJ_MALLOC(sizeof(int) * FaceCount);
+		Attributes->material_ids = (int*)TINYOBJ_MALLOC(sizeof(int) * FaceCount);
+		Attributes->num_face_num_verts = (unsigned int)FaceCount;
+
+		Failed = (VertexCount > 0 && !Attributes->vertices)
+			|| (NormalCount > 0 && !Attributes->normals)
+			|| (TexcoordCount > 0 && !Attributes->texcoords)
+			|| (FaceVertexCount > 0 && !Attributes->faces)
+			|| (FaceCount > 0 && (!Attributes->face_num_verts || !Attributes->material_ids));
+	}
+
+	if (Failed)
+	{
+		printf("Failed to allocate while parsing '%s'\n", Path);
+
+		for (size_t i = 0; i < ChunkCount; ++i)
+			free_chunk(&Chunks[i]);
+
+		free(Chunks);
+		tinyobj_attrib_free(Attributes);
+		tinyobj_attrib_init(Attributes);
+
+		return TINYOBJ_ERROR_EMPTY;
+	}
+
+	hash_table_t MaterialTable;
+	create_hash_table(HASH_TABLE_DEFAULT_SIZE, &MaterialTable);
+
+	if (MtlLib)
+		load_mtllib(Path, MtlLib, MtlLibLength, Materials, MaterialCount, &MaterialTable);
+
+	// A chunk starts with whatever material the previous one ended on
+	int Material = -1;
+
+	for (size_t i = 0; i < ChunkCount; ++i)
+	{
+		ObjChunk_t* Chunk = &Chunks[i];
+
+		Chunk->StartMaterial = Material;
+		Chunk->Out = Attributes;
+
+		for (size_t s = 0; s < Chunk->MaterialSwitchCount; ++s)
+			Material = Chunk->MaterialSwitches[s].Material = find_material(&Chunk->MaterialSwitches[s], &MaterialTable);
+	}
+
+	destroy_hash_table(&MaterialTable);
+
+	for (size_t i = 0; i < ChunkCount; ++i)
+		ogt_submit_job(merge_chunk, &Chunks[i], &Counter);
+
+	ogt_wait_for_jobs(&Counter);
+
+	for (size_t i = 0; i < ChunkCount; ++i)
+		free_chunk(&Chunks[i]);
+
+	free(Chunks);
+
+	return TINYOBJ_SUCCESS;
+}
+
+int parse_obj_serial(tinyobj_attrib_t* Attributes, tinyobj_material_t** Materials, size_t* MaterialCount, const char* Path)
+{
+	tinyobj_shape_t* Shapes = NULL;
+	size_t ShapeCount = 0;
+
+	int Result = tinyobj_parse_obj(Attributes, &Shapes, &ShapeCount, Materials, MaterialCount, Path, get_file_data, NULL, TINYOBJ_FLAG_TRIANGULATE);
+
+	if (Result == TINYOBJ_SUCCESS)
+		tinyobj_shapes_free(Shapes, ShapeCount);
+
+	return Result;
+}
+
+char* find_obj_material_library(const char* Path)
+{
+	void* Data;
+	size_t Size;
+
+	if (!map_file(Path, &Data, &Size))
+		return NULL;
+
+	const char* Text = (const char*)Data;
+	const char* Name = NULL;
+	size_t NameLength = 0;
+
+	// Like the parsers, the last mtllib line wins
+	for (size_t Start = 0; Start < Size;)
+	{
+		const char* End = memchr(Text + Start, '\n', Size - Start);
+		size_t LineEnd = End ? (size_t)(End - Text) : Size;
+		size_t i = Start;
+
+		while (i < LineEnd && IS_SPACE(Text[i]))
+			++i;
+
+		if (LineEnd - i > 7 && strncmp(Text + i, "mtllib", 6) == 0 && IS_SPACE(Text[i + 6]))
+		{
+			i += 7;
+
+			while (i < LineEnd && IS_SPACE(Text[i]))
+				++i;
+
+			Name = Text + i;
+			NameLength = length_until_line_feed(Name, LineEnd - i);
+		}
+
+		Start = LineEnd + 1;
+	}
+
+	char* MtlPath = NULL;
+
+	if (Name && NameLength > 0)
+	{
+		size_t PathLength = my_strnlen(Path, 4096 + 255) + 1;
+		char* MtlName = my_strndup(Name, NameLength);
+
+		if (MtlName)
+			MtlPath = generate_mtl_filename(Path, PathLength, MtlName, NameLength + 1);
+
+		free(MtlName);
+	}
+
+	unmap_file(Data, Size);
+
+	return MtlPath;
+}
+
+int parse_obj(tinyobj_attrib_t* Attributes, tinyobj_material_t** Materials, size_t* MaterialCount, const char* Path)
+{
+	void* Data;
+	size_t Size;
+
+	if (ogt_get_worker_count() > 0 && map_file(Path, &Data, &Size))
+	{
+		if (Size >= OBJ_PARALLEL_MIN_SIZE)
+		{
+			int Result = parse_obj_parallel(Attributes, Materials, MaterialCount, Path, (const char*)Data, Size);
+			unmap_file(Data, Size);
+
+			return Result;
+		}
+
+		unmap_file(Data, Size);
+	}
+
+	return parse_obj_serial(Attributes, Materials, MaterialCount, Path);
+}
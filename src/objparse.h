@@ -0,0 +1,17 @@
+#ifndef ogt_obj_parse
+#define ogt_obj_parse
+
+#include <stddef.h>
+#include <tinyobj_loader_c.h>
+
+#define OBJ_PARALLEL_MIN_SIZE (1 << 20) // Files smaller than this are parsed on the calling thread
+#define OBJ_MIN_CHUNK_SIZE (64 << 10)
+#define OBJ_CHUNKS_PER_THREAD 4
+
+// Same output as tinyobj_parse_obj with TINYOBJ_FLAG_TRIANGULATE, minus the shape list
+int parse_obj(tinyobj_attrib_t* Attributes, tinyobj_material_t** Materials, size_t* MaterialCount, const char* Path);
+int parse_obj_serial(tinyobj_attrib_t* Attributes, tinyobj_material_t** Materials, size_t* MaterialCount, const char* Path);
+int parse_obj_parallel(tinyobj_attrib_t* Attributes, tinyobj_material_t** Materials, size_t* MaterialCount, const char* Path, const char* Data, size_t Size);
+char* find_obj_material_library(const char* Path); // Resolved path of the mtllib the parsers would load, NULL without one, free the result
+
+#endif
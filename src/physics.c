@@ -1,6 +1,10 @@
+#include "physics.h"
+
 #include <ode/ode.h>
+#include <cglm/cglm.h>
 
 #include "globals.h"
+#include "util.h"
 
 void ogt_init_physics()
 {
@@ -44,3 +48,53 @@ void ogt_simulate_physics(float DeltaTime)
 	dWorldStep(GlobalVars->PhysicsManager->World, DeltaTime);
 	dJointGroupEmpty(GlobalVars->PhysicsManager->ContactGroup);
 }
+
+void ogt_sync_body(dBodyID Body, float* Origin, float* Angles)
+{
+	const dReal* Pos = dBodyGetPosition(Body);
+	glm_vec3_copy((vec3){ Pos[0], Pos[1], Pos[2] }, Origin);
+
+	const dReal* AngularVelocity = dBodyGetAngularVel(Body);
+	dBodySetAngularVel(Body, AngularVelocity[0] * 0.98f, AngularVelocity[1] * 0.98f, AngularVelocity[2] * 0.98f); // SLOW THE FUCK DOWN
+
+	const dReal* Rot = dBodyGetQuaternion(Body);
+	versor Q = { Rot[1], Rot[2], Rot[3], Rot[0] };
+
+	vec3 Euler;
+	quat_to_euler_deg(Q, Euler);
+	glm_vec3_scale(Euler, (float)(180.0 / M_PI), Angles);
+
+	normalize_angles(Angles);
+}
+
+bool ogt_fit_box_to_model(dBodyID Body, dGeomID Geometry, ModelInfo_t* ModelInfo, dReal Mass)
+{
+	if (!Geometry || dGeomGetClass(Geometry) != dBoxClass)
+		return 0;
+
+	vec3 Mins, Maxs;
+
+	if (!ogt_get_model_bounds(ModelInfo, Mins, Maxs))
+		return 0;
+
+	vec3 Size, Center;
+	glm_vec3_sub(Maxs, Mins, Size);
+	glm_vec3_center(Mins, Maxs, Center);
+
+	// Flat models still need some thickness to collide
+	glm_vec3_maxv(Size, (vec3){ 0.01f, 0.01f, 0.01f }, Size);
+
+	dGeomBoxSetLengths(Geometry, Size[0], Size[1], Size[2]);
+
+	if (Body)
+	{
+		// ODE wants the center of mass on the body origin, so only the geometry is moved onto the mesh
+		dGeomSetOffsetPosition(Geometry, Center[0], Center[1], Center[2]);
+
+		dMass BoxMass;
+		dMassSetBoxTotal(&BoxMass, Mass, Size[0], Size[1], Size[2]);
+		dBodySetMass(Body, &BoxMass);
+	}
+
+	return 1;
+}
@@ -3,6 +3,8 @@
 
 #include <ode/ode.h>
 
+#include "models.h"
+
 typedef struct
 {
 	dWorldID World;
@@ -12,5 +14,7 @@ typedef struct
 
 void ogt_init_physics();
 void ogt_simulate_physics(float DeltaTime);
+void ogt_sync_body(dBodyID Body, float* Origin, float* Angles); // Copies the body's pose out, angles in degrees
+bool ogt_fit_box_to_model(dBodyID Body, dGeomID Geometry, ModelInfo_t* ModelInfo, dReal Mass); // Fails until the model is loaded or when it isn't a box
 
 #endif
@@ -68,8 +68,20 @@ void ogt_render_view(RenderView_t* View, float DeltaTime)
 	glUniform3fv(viewPosLoc, 1, (float*)View->Origin);
 
 	unsigned int texUniformLoc = glGetUniformLocation(ShaderProgram, "ourTexture");
-	glUniform1i(texUniformLoc, 0);
+	glUniform1i(texUniformLoc, TEXTURE_UNIT_2D);
+
+	unsigned int texArrayUniformLoc = glGetUniformLocation(ShaderProgram, "ourTextureArray");
+	glUniform1i(texArrayUniformLoc, TEXTURE_UNIT_ARRAY);
+
+	GlobalVars->CurrentView = View;
+	ogt_reset_geometry_binding();
+	ogt_reset_texture_binding();
 
 	if (View->RenderEntities)
+	{
 		ogt_render_entities(DeltaTime);
+		ogt_ecs_render();
+	}
+
+	GlobalVars->CurrentView = NULL;
 }
@@ -10,8 +10,10 @@ in vec3 MaterialDiffuse;
 in vec3 MaterialSpecular;
 in float MaterialShininess;
 
-uniform int useTexture;
+uniform int useTexture; // 1 samples ourTexture, 2 samples layer textureLayer of ourTextureArray
 uniform sampler2D ourTexture;
+uniform sampler2DArray ourTextureArray;
+uniform float textureLayer;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 uniform vec3 lightColor;
@@ -41,7 +43,7 @@ void main()
 
 	vec3 baseColor = objectColor;
 
-	if (useTexture != 1)
+	if (useTexture == 0)
 	{
 		baseColor *= MaterialColor;
 	}
@@ -52,6 +54,12 @@ void main()
 		baseColor *= texColor.rgb;
 	}
 
+	if (useTexture == 2)
+	{
+		vec4 texColor = texture(ourTextureArray, vec3(TexCoord, textureLayer));
+		baseColor *= texColor.rgb;
+	}
+
 	vec3 finalColor = lighting * baseColor;
 	FragColor = vec4(finalColor, 1.0);
 }
@@ -1,8 +1,9 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+layout (location = 0) in vec4 aPos; // w holds the bitangent sign for compact vertices, unused until normal mapping
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in vec3 aMaterialColor;
+layout (location = 4) in vec4 aTangent; // Not read until a shader does normal mapping, declared so the layout matches the vertex format
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -17,13 +18,36 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+uniform int compactVertices;
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+vec3 decodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+
+	return normalize(n);
+}
+
 void main()
 {
-	vec4 worldPos = model * vec4(aPos, 1.0);
+	vec3 position = aPos.xyz;
+	vec3 normal = aNormal;
+
+	if (compactVertices == 1)
+	{
+		position = positionOffset + aPos.xyz * positionScale;
+		normal = decodeOctahedral(aNormal.xy);
+	}
+
+	vec4 worldPos = model * vec4(position, 1.0);
 	FragPos = worldPos.xyz;
 
 	mat3 normalMatrix = mat3(transpose(inverse(model)));
-	Normal = normalize(normalMatrix * aNormal);
+	Normal = normalize(normalMatrix * normal);
 
 	TexCoord = aTexCoord;
 	MaterialColor = aMaterialColor;
@@ -0,0 +1,437 @@
+#include "simplify.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <cglm/cglm.h>
+#include <hashmap/map.h>
+
+typedef struct
+{
+	double A00, A01, A02, A11, A12, A22;
+	double B0, B1, B2;
+	double C;
+	double Weight;
+} Quadric_t;
+
+typedef struct
+{
+	unsigned int From;
+	unsigned int To;
+	float Cost;
+} Collapse_t;
+
+static void add_plane_quadric(Quadric_t* Quadric, const vec3 Normal, float Distance, float Weight)
+{
+	Quadric->A00 += Weight * Normal[0] * Normal[0];
+	Quadric->A01 += Weight * Normal[0] * Normal[1];
+	Quadric->A02 += Weight * Normal[0] * Normal[2];
+	Quadric->A11 += Weight * Normal[1] * Normal[1];
+	Quadric->A12 += Weight * Normal[1] * Normal[2];
+	Quadric->A22 += Weight * Normal[2] * Normal[2];
+	Quadric->B0 += Weight * Normal[0] * Distance;
+	Quadric->B1 += Weight * Normal[1] * Distance;
+	Quadric->B2 += Weight * Normal[2] * Distance;
+	Quadric->C += Weight * Distance * Distance;
+	Quadric->Weight += Weight;
+}
+
+static void add_quadric(Quadric_t* Quadric, const Quadric_t* Other)
+{
+	Quadric->A00 += Other->A00;
+	Quadric->A01 += Other->A01;
+	Quadric->A02 += Other->A02;
+	Quadric->A11 += Other->A11;
+	Quadric->A12 += Other->A12;
+	Quadric->A22 += Other->A22;
+	Quadric->B0 += Other->B0;
+	Quadric->B1 += Other->B1;
+	Quadric->B2 += Other->B2;
+	Quadric->C += Other->C;
+	Quadric->Weight += Other->Weight;
+}
+
+// Area weighted mean of squared distances to the planes
+static float get_collapse_cost(const Quadric_t* A, const Quadric_t* B, const float* Position)
+{
+	double X = Position[0], Y = Position[1], Z = Position[2];
+	double Weight = A->Weight + B->Weight;
+
+	if (Weight <= 0.0)
+		return 0.f;
+
+	double Error =
+		(A->A00 + B->A00) * X * X
+		+ 2.0 * (A->A01 + B->A01) * X * Y
+		+ 2.0 * (A->A02 + B->A02) * X * Z
+		+ (A->A11 + B->A11) * Y * Y
+		+ 2.0 * (A->A12 + B->A12) * Y * Z
+		+ (A->A22 + B->A22) * Z * Z
+		+ 2.0 * ((A->B0 + B->B0) * X + (A->B1 + B->B1) * Y + (A->B2 + B->B2) * Z)
+		+ (A->C + B->C);
+
+	return Error > 0.0 ? (float)(Error / Weight) : 0.f;
+}
+
+static int compare_collapses(const void* A, const void* B)
+{
+	float CostA = ((const Collapse_t*)A)->Cost;
+	float CostB = ((const Collapse_t*)B)->Cost;
+
+	return CostA < CostB ? -1 : (CostA > CostB);
+}
+
+static int compare_edges(const void* A, const void* B)
+{
+	uint64_t EdgeA = *(const uint64_t*)A;
+	uint64_t EdgeB = *(const uint64_t*)B;
+
+	return EdgeA < EdgeB ? -1 : (EdgeA > EdgeB);
+}
+
+static bool is_collapse_flipping(const float* Vertices, size_t Stride, const unsigned int* Corners, const unsigned int* Offsets, const unsigned int* Adjacency, unsigned int From, unsigned int To)
+{
+	const float* Target = &Vertices[To * Stride];
+
+	for (unsigned int a = Offsets[From]; a < Offsets[From + 1]; ++a)
+	{
+		const unsigned int* Triangle = &Corners[Adjacency[a] * 3];
+
+		if (Triangle[0] == To || Triangle[1] == To || Triangle[2] == To)
+			continue; // Collapses away
+
+		const float* Before[3];
+		const float* After[3];
+
+		for (int Vert = 0; Vert < 3; ++Vert)
+		{
+			Before[Vert] = &Vertices[Triangle[Vert] * Stride];
+			After[Vert] = Triangle[Vert] == From ? Target : Before[Vert];
+		}
+
+		vec3 AB, AC, NormalBefore, NormalAfter;
+
+		glm_vec3_sub((float*)Before[1], (float*)Before[0], AB);
+		glm_vec3_sub((float*)Before[2], (float*)Before[0], AC);
+		glm_vec3_cross(AB, AC, NormalBefore);
+
+		glm_vec3_sub((float*)After[1], (float*)After[0], AB);
+		glm_vec3_sub((float*)After[2], (float*)After[0], AC);
+		glm_vec3_cross(AB, AC, NormalAfter);
+
+		float Dot = glm_vec3_dot(NormalBefore, NormalAfter);
+
+		if (Dot <= SIMPLIFY_MIN_NORMAL_DOT * glm_vec3_norm(NormalBefore) * glm_vec3_norm(NormalAfter))
+			return 1;
+	}
+
+	return 0;
+}
+
+// Picks the vertex at Position whose other attributes are closest to Original's
+static unsigned int find_attribute_vertex(const float* Vertices, size_t Stride, const unsigned int* GroupOffsets, const unsigned int* Groups, unsigned int Position, unsigned int Original)
+{
+	unsigned int Best = Position;
+	float BestDistance = INFINITY;
+
+	for (unsigned int g = GroupOffsets[Position]; g < GroupOffsets[Position + 1]; ++g)
+	{
+		const float* Candidate = &Vertices[Groups[g] * Stride];
+		const float* Wanted = &Vertices[Original * Stride];
+		float Distance = 0.f;
+
+		for (size_t k = 3; k < Stride; ++k)
+			Distance += (Candidate[k] - Wanted[k]) * (Candidate[k] - Wanted[k]);
+
+		if (Distance < BestDistance)
+		{
+			Best = Groups[g];
+			BestDistance = Distance;
+		}
+	}
+
+	return Best;
+}
+
+size_t simplify_mesh(const float* Vertices, size_t Stride, size_t VertexCount, const unsigned int* Indices, size_t IndexCount, unsigned int* Out, size_t TargetIndexCount, float MaxError, float* Error)
+{
+	*Error = 0.f;
+
+	if (TargetIndexCount >= IndexCount || IndexCount < 3)
+	{
+		memcpy(Out, Indices, IndexCount * sizeof(unsigned int));
+
+		return IndexCount;
+	}
+
+	unsigned int* Remap = malloc(VertexCount * sizeof(unsigned int)); // Attribute vertex to the first vertex at its position
+	unsigned int* Collapses = malloc(VertexCount * sizeof(unsigned int));
+	Quadric_t* Quadrics = calloc(VertexCount, sizeof(Quadric_t));
+	bool* Locked = calloc(VertexCount, sizeof(bool));
+	bool* Touched = calloc(VertexCount, sizeof(bool));
+	unsigned int* Offsets = calloc(VertexCount + 1, sizeof(unsigned int));
+	unsigned int* Adjacency = malloc(IndexCount * sizeof(unsigned int));
+	unsigned int* Corners = malloc(IndexCount * sizeof(unsigned int)); // Welded
+	unsigned int* Sources = malloc(IndexCount * sizeof(unsigned int)); // Attribute vertex each corner started as
+	uint64_t* Edges = malloc(IndexCount * sizeof(uint64_t));
+	Collapse_t* Candidates = malloc(IndexCount * sizeof(Collapse_t));
+	hashmap* PositionMap = hashmap_create();
+
+	if (!Remap || !Collapses || !Quadrics || !Locked || !Touched || !Offsets || !Adjacency || !Corners || !Sources || !Edges || !Candidates || !PositionMap)
+	{
+		free(Remap);
+		free(Collapses);
+		free(Quadrics);
+		free(Locked);
+		free(Touched);
+		free(Offsets);
+		free(Adjacency);
+		free(Corners);
+		free(Sources);
+		free(Edges);
+		free(Candidates);
+
+		if (PositionMap)
+			hashmap_free(PositionMap);
+
+		memcpy(Out, Indices, IndexCount * sizeof(unsigned int));
+
+		return IndexCount;
+	}
+
+	for (size_t i = 0; i < VertexCount; ++i)
+	{
+		Remap[i] = (unsigned int)i;
+		Collapses[i] = (unsigned int)i;
+	}
+
+	// Weld by position so hard edges and UV seams don't stop collapses
+	for (size_t i = 0; i < IndexCount; ++i)
+	{
+		uintptr_t Welded = Indices[i];
+
+		hashmap_get_set(PositionMap, &Vertices[Indices[i] * Stride], 3 * sizeof(float), &Welded);
+
+		Remap[Indices[i]] = (unsigned int)Welded;
+		Corners[i] = (unsigned int)Welded;
+		Sources[i] = Indices[i];
+	}
+
+	hashmap_free(PositionMap);
+
+	size_t TriangleCount = IndexCount / 3;
+
+	for (size_t Triangle = 0; Triangle < TriangleCount; ++Triangle)
+	{
+		const unsigned int* TriangleCorners = &Corners[Triangle * 3];
+		const float* A = &Vertices[TriangleCorners[0] * Stride];
+		const float* B = &Vertices[TriangleCorners[1] * Stride];
+		const float* C = &Vertices[TriangleCorners[2] * Stride];
+
+		vec3 AB, AC, Normal;
+		glm_vec3_sub((float*)B, (float*)A, AB);
+		glm_vec3_sub((float*)C, (float*)A, AC);
+		glm_vec3_cross(AB, AC, Normal);
+
+		float Area = glm_vec3_norm(Normal);
+
+		if (Area > 0.f)
+		{
+			glm_vec3_divs(Normal, Area, Normal);
+
+			float Distance = -glm_vec3_dot(Normal, (float*)A);
+
+			for (int Vert = 0; Vert < 3; ++Vert)
+				add_plane_quadric(&Quadrics[TriangleCorners[Vert]], Normal, Distance, Area * .5f);
+		}
+
+		for (int Vert = 0; Vert < 3; ++Vert)
+		{
+			uint64_t V0 = TriangleCorners[Vert];
+			uint64_t V1 = TriangleCorners[(Vert + 1) % 3];
+
+			Edges[(Triangle * 3) + Vert] = V0 < V1 ? (V0 << 32) | V1 : (V1 << 32) | V0;
+		}
+	}
+
+	// Edges that aren't shared by exactly two triangles are borders (or worse), their vertices stay put
+	qsort(Edges, IndexCount, sizeof(uint64_t), compare_edges);
+
+	for (size_t i = 0; i < IndexCount;)
+	{
+		size_t Run = 1;
+
+		while (i + Run < IndexCount && Edges[i + Run] == Edges[i])
+			Run++;
+
+		if (Run != 2)
+		{
+			Locked[Edges[i] >> 32] = 1;
+			Locked[Edges[i] & UINT32_MAX] = 1;
+		}
+
+		i += Run;
+	}
+
+	float MaxCost = MaxError * MaxError;
+	float WorstCost = 0.f;
+
+	while (TriangleCount * 3 > TargetIndexCount)
+	{
+		memset(Offsets, 0, (VertexCount + 1) * sizeof(unsigned int));
+
+		for (size_t i = 0; i < TriangleCount * 3; ++i)
+			Offsets[Corners[i] + 1]++;
+
+		for (size_t i = 0; i < VertexCount; ++i)
+			Offsets[i + 1] += Offsets[i];
+
+		for (size_t i = 0; i < TriangleCount * 3; ++i)
+			Adjacency[Offsets[Corners[i]]++] = (unsigned int)(i / 3);
+
+		for (size_t i = VertexCount; i > 0; --i)
+			Offsets[i] = Offsets[i - 1];
+
+		Offsets[0] = 0;
+
+		size_t CandidateCount = 0;
+
+		for (size_t i = 0; i < TriangleCount * 3; ++i)
+		{
+			unsigned int V0 = Corners[i];
+			unsigned int V1 = Corners[((i / 3) * 3) + ((i + 1) % 3)];
+
+			if (V0 == V1 || (Locked[V0] && Locked[V1]))
+				continue;
+
+			float Cost0 = Locked[V0] ? INFINITY : get_collapse_cost(&Quadrics[V0], &Quadrics[V1], &Vertices[V1 * Stride]);
+			float Cost1 = Locked[V1] ? INFINITY : get_collapse_cost(&Quadrics[V0], &Quadrics[V1], &Vertices[V0 * Stride]);
+
+			Collapse_t* Candidate = &Candidates[CandidateCount++];
+			Candidate->From = Cost0 <= Cost1 ? V0 : V1;
+			Candidate->To = Cost0 <= Cost1 ? V1 : V0;
+			Candidate->Cost = Cost0 <= Cost1 ? Cost0 : Cost1;
+		}
+
+		qsort(Candidates, CandidateCount, sizeof(Collapse_t), compare_collapses);
+
+		size_t TrianglesToRemove = TriangleCount - (TargetIndexCount / 3);
+		size_t Removed = 0;
+		size_t CollapseCount = 0;
+
+		memset(Touched, 0, VertexCount * sizeof(bool));
+
+		for (size_t c = 0; c < CandidateCount && Removed < TrianglesToRemove; ++c)
+		{
+			Collapse_t* Candidate = &Candidates[c];
+
+			if (Candidate->Cost > MaxCost)
+				break;
+
+			if (Touched[Candidate->From] || Touched[Candidate->To])
+				continue;
+
+			if (is_collapse_flipping(Vertices, Stride, Corners, Offsets, Adjacency, Candidate->From, Candidate->To))
+				continue;
+
+			// Everything around From changes shape, so nothing else touching it moves this pass
+			for (unsigned int a = Offsets[Candidate->From]; a < Offsets[Candidate->From + 1]; ++a)
+			{
+				const unsigned int* Triangle = &Corners[Adjacency[a] * 3];
+
+				if (Triangle[0] == Candidate->To || Triangle[1] == Candidate->To || Triangle[2] == Candidate->To)
+					Removed++;
+
+				Touched[Triangle[0]] = 1;
+				Touched[Triangle[1]] = 1;
+				Touched[Triangle[2]] = 1;
+			}
+
+			Collapses[Candidate->From] = Candidate->To;
+			add_quadric(&Quadrics[Candidate->To], &Quadrics[Candidate->From]);
+
+			if (Candidate->Cost > WorstCost)
+				WorstCost = Candidate->Cost;
+
+			CollapseCount++;
+		}
+
+		if (CollapseCount == 0)
+			break;
+
+		size_t Kept = 0;
+
+		for (size_t Triangle = 0; Triangle < TriangleCount; ++Triangle)
+		{
+			unsigned int V0 = Collapses[Corners[(Triangle * 3) + 0]];
+			unsigned int V1 = Collapses[Corners[(Triangle * 3) + 1]];
+			unsigned int V2 = Collapses[Corners[(Triangle * 3) + 2]];
+
+			if (V0 == V1 || V1 == V2 || V0 == V2)
+				continue;
+
+			Corners[(Kept * 3) + 0] = V0;
+			Corners[(Kept * 3) + 1] = V1;
+			Corners[(Kept * 3) + 2] = V2;
+
+			// Attribute corners travel with their triangle, they're only swapped out at the end
+			Sources[(Kept * 3) + 0] = Sources[(Triangle * 3) + 0];
+			Sources[(Kept * 3) + 1] = Sources[(Triangle * 3) + 1];
+			Sources[(Kept * 3) + 2] = Sources[(Triangle * 3) + 2];
+
+			Kept++;
+		}
+
+		for (size_t i = 0; i < VertexCount; ++i)
+			Collapses[i] = (unsigned int)i;
+
+		TriangleCount = Kept;
+	}
+
+	// Group the attribute vertices by position, Offsets and Adjacency get reused for it
+	memset(Offsets, 0, (VertexCount + 1) * sizeof(unsigned int));
+	memset(Touched, 0, VertexCount * sizeof(bool));
+
+	for (size_t i = 0; i < IndexCount; ++i)
+	{
+		if (Touched[Indices[i]])
+			continue;
+
+		Touched[Indices[i]] = 1;
+		Offsets[Remap[Indices[i]] + 1]++;
+	}
+
+	for (size_t i = 0; i < VertexCount; ++i)
+		Offsets[i + 1] += Offsets[i];
+
+	memcpy(Collapses, Offsets, VertexCount * sizeof(unsigned int));
+
+	for (size_t i = 0; i < VertexCount; ++i)
+		if (Touched[i])
+			Adjacency[Collapses[Remap[i]]++] = (unsigned int)i;
+
+	for (size_t i = 0; i < TriangleCount * 3; ++i)
+	{
+		if (Remap[Sources[i]] == Corners[i])
+			Out[i] = Sources[i];
+		else
+			Out[i] = find_attribute_vertex(Vertices, Stride, Offsets, Adjacency, Corners[i], Sources[i]);
+	}
+
+	free(Remap);
+	free(Collapses);
+	free(Quadrics);
+	free(Locked);
+	free(Touched);
+	free(Offsets);
+	free(Adjacency);
+	free(Corners);
+	free(Sources);
+	free(Edges);
+	free(Candidates);
+
+	*Error = sqrtf(WorstCost);
+
+	return TriangleCount * 3;
+}
@@ -0,0 +1,14 @@
+#ifndef ogt_simplify
+#define ogt_simplify
+
+#include <stddef.h>
+
+#define SIMPLIFY_MIN_NORMAL_DOT 0.2f // Collapses that turn a triangle further than this (cosine) are rejected
+
+// Quadric error edge collapse, every collapse lands on an existing vertex so LODs can share one vertex buffer.
+// Vertices start with a position, the rest of each Stride floats is used to pick a matching vertex where
+// positions with several attribute sets (hard edges, seams) get collapsed. Border edges are never moved.
+// Writes at most IndexCount indices to Out and returns how many, Error gets the worst distance error introduced.
+size_t simplify_mesh(const float* Vertices, size_t Stride, size_t VertexCount, const unsigned int* Indices, size_t IndexCount, unsigned int* Out, size_t TargetIndexCount, float MaxError, float* Error);
+
+#endif
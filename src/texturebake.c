@@ -0,0 +1,734 @@
+#include "texturebake.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include <glad/glad.h>
+
+#include "util.h"
+#include "mipgen.h"
+
+// Core profile headers leave the S3TC enums out
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+static const char* FormatNames[TEXTURE_BAKE_FORMAT_COUNT] = { "R8", "RGB8", "RGBA8", "BC1", "BC3", "BC4" };
+
+static char* get_bake_path(const char* Path)
+{
+	size_t Length = strlen(Path);
+	char* BakePath = malloc(Length + sizeof(TEXTURE_BAKE_EXTENSION));
+
+	if (!BakePath)
+		return NULL;
+
+	memcpy(BakePath, Path, Length);
+	memcpy(BakePath + Length, TEXTURE_BAKE_EXTENSION, sizeof(TEXTURE_BAKE_EXTENSION));
+
+	return BakePath;
+}
+
+static char* get_cached_bake_path(uint64_t Key)
+{
+	char Name[64];
+	int Length = snprintf(Name, sizeof(Name), "%s/%016" PRIx64 "%s", TEXTURE_BAKE_CACHE_DIRECTORY, Key, TEXTURE_BAKE_EXTENSION);
+	char* BakePath = malloc((size_t)Length + 1);
+
+	if (BakePath)
+		memcpy(BakePath, Name, (size_t)Length + 1);
+
+	return BakePath;
+}
+
+static bool is_bake_stale(const char* Path, const char* BakePath)
+{
+	time_t SourceTime, BakeTime;
+
+	if (!get_file_time(BakePath, &BakeTime))
+		return 1;
+
+	if (!get_file_time(Path, &SourceTime))
+		return 0; // Shipped without the source
+
+	return SourceTime > BakeTime;
+}
+
+static bool is_format_compressed(uint32_t Format)
+{
+	return Format == TEXTURE_BAKE_FORMAT_BC1 || Format == TEXTURE_BAKE_FORMAT_BC3 || Format == TEXTURE_BAKE_FORMAT_BC4;
+}
+
+size_t get_texture_bake_level_size(uint32_t Format, size_t Width, size_t Height)
+{
+	size_t Blocks = ((Width + 3) / 4) * ((Height + 3) / 4);
+
+	switch (Format)
+	{
+		case TEXTURE_BAKE_FORMAT_R8: return Width * Height;
+		case TEXTURE_BAKE_FORMAT_RGB8: return Width * Height * 3;
+		case TEXTURE_BAKE_FORMAT_RGBA8: return Width * Height * 4;
+		case TEXTURE_BAKE_FORMAT_BC1: return Blocks * 8;
+		case TEXTURE_BAKE_FORMAT_BC3: return Blocks * 16;
+		case TEXTURE_BAKE_FORMAT_BC4: return Blocks * 8;
+	}
+
+	return 0;
+}
+
+bool get_texture_bake_gl_format(uint32_t Format, unsigned int* InternalFormat, unsigned int* PixelFormat)
+{
+	switch (Format)
+	{
+		case TEXTURE_BAKE_FORMAT_R8:
+			*InternalFormat = *PixelFormat = GL_RED;
+			return 0;
+
+		case TEXTURE_BAKE_FORMAT_RGB8:
+			*InternalFormat = *PixelFormat = GL_RGB;
+			return 0;
+
+		default:
+		case TEXTURE_BAKE_FORMAT_RGBA8:
+			*InternalFormat = *PixelFormat = GL_RGBA;
+			return 0;
+
+		case TEXTURE_BAKE_FORMAT_BC1:
+			*InternalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			break;
+
+		case TEXTURE_BAKE_FORMAT_BC3:
+			*InternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			break;
+
+		case TEXTURE_BAKE_FORMAT_BC4:
+			*InternalFormat = GL_COMPRESSED_RED_RGTC1;
+			break;
+	}
+
+	*PixelFormat = 0;
+
+	return 1;
+}
+
+// Pulls a 4x4 block out as RGBA, edges repeat the last pixel
+static void fetch_block(const unsigned char* Pixels, int Width, int Height, int Channels, int BlockX, int BlockY, unsigned char Block[16][4])
+{
+	for (int y = 0; y < 4; ++y)
+	{
+		int py = BlockY * 4 + y < Height ? BlockY * 4 + y : Height - 1;
+
+		for (int x = 0; x < 4; ++x)
+		{
+			int px = BlockX * 4 + x < Width ? BlockX * 4 + x : Width - 1;
+			const unsigned char* Pixel = &Pixels[((size_t)py * Width + px) * Channels];
+			unsigned char* Out = Block[y * 4 + x];
+
+			if (Channels == 1)
+			{
+				Out[0] = Out[1] = Out[2] = Pixel[0];
+				Out[3] = 255;
+			}
+			else
+			{
+				Out[0] = Pixel[0];
+				Out[1] = Pixel[1];
+				Out[2] = Pixel[2];
+				Out[3] = Channels == 4 ? Pixel[3] : 255;
+			}
+		}
+	}
+}
+
+static unsigned short pack_565(const float Color[3])
+{
+	int r = (int)(Color[0] * 31.0f / 255.0f + 0.5f);
+	int g = (int)(Color[1] * 63.0f / 255.0f + 0.5f);
+	int b = (int)(Color[2] * 31.0f / 255.0f + 0.5f);
+
+	r = r < 0 ? 0 : (r > 31 ? 31 : r);
+	g = g < 0 ? 0 : (g > 63 ? 63 : g);
+	b = b < 0 ? 0 : (b > 31 ? 31 : b);
+
+	return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(unsigned short Packed, int Color[3])
+{
+	int r = (Packed >> 11) & 31;
+	int g = (Packed >> 5) & 63;
+	int b = Packed & 31;
+
+	Color[0] = (r << 3) | (r >> 2);
+	Color[1] = (g << 2) | (g >> 4);
+	Color[2] = (b << 3) | (b >> 2);
+}
+
+// Endpoints are the block's extremes along its principal axis, always in four colour mode
+static void encode_color_block(const unsigned char Block[16][4], unsigned char* Out)
+{
+	float Mean[3] = { 0 };
+
+	for (int i = 0; i < 16; ++i)
+		for (int c = 0; c < 3; ++c)
+			Mean[c] += Block[i][c] / 16.0f;
+
+	float Covariance[6] = { 0 }; // xx xy xz yy yz zz
+
+	for (int i = 0; i < 16; ++i)
+	{
+		float d[3] = { Block[i][0] - Mean[0], Block[i][1] - Mean[1], Block[i][2] - Mean[2] };
+
+		Covariance[0] += d[0] * d[0];
+		Covariance[1] += d[0] * d[1];
+		Covariance[2] += d[0] * d[2];
+		Covariance[3] += d[1] * d[1];
+		Covariance[4] += d[1] * d[2];
+		Covariance[5] += d[2] * d[2];
+	}
+
+	float Axis[3] = { 1.0f, 1.0f, 1.0f };
+
+	for (int Iteration = 0; Iteration < 8; ++Iteration)
+	{
+		float Next[3] = {
+			Covariance[0] * Axis[0] + Covariance[1] * Axis[1] + Covariance[2] * Axis[2],
+			Covariance[1] * Axis[0] + Covariance[3] * Axis[1] + Covariance[4] * Axis[2],
+			Covariance[2] * Axis[0] + Covariance[4] * Axis[1] + Covariance[5] * Axis[2]
+		};
+
+		float Largest = fabsf(Next[0]);
+
+		if (fabsf(Next[1]) > Largest) Largest = fabsf(Next[1]);
+		if (fabsf(Next[2]) > Largest) Largest = fabsf(Next[2]);
+
+		if (Largest < 1e-6f)
+			break; // Flat block, any axis will do
+
+		for (int c = 0; c < 3; ++c)
+			Axis[c] = Next[c] / Largest;
+	}
+
+	int MinIndex = 0, MaxIndex = 0;
+	float MinDot = 0.0f, MaxDot = 0.0f;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		float Dot = (Block[i][0] - Mean[0]) * Axis[0] + (Block[i][1] - Mean[1]) * Axis[1] + (Block[i][2] - Mean[2]) * Axis[2];
+
+		if (i == 0 || Dot < MinDot) { MinDot = Dot; MinIndex = i; }
+		if (i == 0 || Dot > MaxDot) { MaxDot = Dot; MaxIndex = i; }
+	}
+
+	float High[3] = { Block[MaxIndex][0], Block[MaxIndex][1], Block[MaxIndex][2] };
+	float Low[3] = { Block[MinIndex][0], Block[MinIndex][1], Block[MinIndex][2] };
+
+	unsigned short Color0 = pack_565(High);
+	unsigned short Color1 = pack_565(Low);
+
+	if (Color0 < Color1)
+	{
+		unsigned short Swap = Color0;
+		Color0 = Color1;
+		Color1 = Swap;
+	}
+
+	Out[0] = Color0 & 0xFF;
+	Out[1] = Color0 >> 8;
+	Out[2] = Color1 & 0xFF;
+	Out[3] = Color1 >> 8;
+
+	uint32_t Indices = 0;
+
+	if (Color0 != Color1)
+	{
+		int Palette[4][3];
+		unpack_565(Color0, Palette[0]);
+		unpack_565(Color1, Palette[1]);
+
+		for (int c = 0; c < 3; ++c)
+		{
+			Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+			Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int Best = 0, BestError = 0;
+
+			for (int p = 0; p < 4; ++p)
+			{
+				int dr = Block[i][0] - Palette[p][0];
+				int dg = Block[i][1] - Palette[p][1];
+				int db = Block[i][2] - Palette[p][2];
+				int Error = dr * dr + dg * dg + db * db;
+
+				if (p == 0 || Error < BestError)
+				{
+					Best = p;
+					BestError = Error;
+				}
+			}
+
+			Indices |= (uint32_t)Best << (i * 2);
+		}
+	}
+
+	Out[4] = Indices & 0xFF;
+	Out[5] = (Indices >> 8) & 0xFF;
+	Out[6] = (Indices >> 16) & 0xFF;
+	Out[7] = Indices >> 24;
+}
+
+// BC3 alpha and BC4 share this, eight value mode between the block's min and max
+static void encode_alpha_block(const unsigned char Block[16][4], int Channel, unsigned char* Out)
+{
+	int High = 0, Low = 255;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		if (Block[i][Channel] > High) High = Block[i][Channel];
+		if (Block[i][Channel] < Low) Low = Block[i][Channel];
+	}
+
+	Out[0] = (unsigned char)High;
+	Out[1] = (unsigned char)Low;
+
+	uint64_t Indices = 0;
+
+	if (High != Low)
+	{
+		int Palette[8] = { High, Low };
+
+		for (int p = 1; p < 7; ++p)
+			Palette[p + 1] = ((7 - p) * High + p * Low) / 7;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int Best = 0, BestError = 256;
+
+			for (int p = 0; p < 8; ++p)
+			{
+				int Error = abs(Block[i][Channel] - Palette[p]);
+
+				if (Error < BestError)
+				{
+					Best = p;
+					BestError = Error;
+				}
+			}
+
+			Indices |= (uint64_t)Best << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; ++i)
+		Out[2 + i] = (unsigned char)(Indices >> (i * 8));
+}
+
+static void compress_level(const unsigned char* Pixels, int Width, int Height, int Channels, uint32_t Format, unsigned char* Out)
+{
+	int BlocksX = (Width + 3) / 4;
+	int BlocksY = (Height + 3) / 4;
+
+	unsigned char Block[16][4];
+
+	for (int by = 0; by < BlocksY; ++by)
+	{
+		for (int bx = 0; bx < BlocksX; ++bx)
+		{
+			fetch_block(Pixels, Width, Height, Channels, bx, by, Block);
+
+			switch (Format)
+			{
+				case TEXTURE_BAKE_FORMAT_BC1:
+					encode_color_block(Block, Out);
+					Out += 8;
+					break;
+
+				case TEXTURE_BAKE_FORMAT_BC3:
+					encode_alpha_block(Block, 3, Out);
+					encode_color_block(Block, Out + 8);
+					Out += 16;
+					break;
+
+				case TEXTURE_BAKE_FORMAT_BC4:
+					encode_alpha_block(Block, 0, Out);
+					Out += 8;
+					break;
+			}
+		}
+	}
+}
+
+static uint32_t pick_format(int Channels, bool Compress)
+{
+	switch (Channels)
+	{
+		case 1: return Compress ? TEXTURE_BAKE_FORMAT_BC4 : TEXTURE_BAKE_FORMAT_R8;
+		case 3: return Compress ? TEXTURE_BAKE_FORMAT_BC1 : TEXTURE_BAKE_FORMAT_RGB8;
+		default: return Compress ? TEXTURE_BAKE_FORMAT_BC3 : TEXTURE_BAKE_FORMAT_RGBA8;
+	}
+}
+
+// Grey and alpha has no GL format of its own
+static bool expand_grey_alpha(TextureData_t* Texture)
+{
+	size_t PixelCount = (size_t)Texture->Width * Texture->Height;
+	unsigned char* Pixels = malloc(PixelCount * 4);
+
+	if (!Pixels)
+		return 0;
+
+	for (size_t i = 0; i < PixelCount; ++i)
+	{
+		Pixels[i * 4 + 0] = Pixels[i * 4 + 1] = Pixels[i * 4 + 2] = Texture->Pixels[i * 2];
+		Pixels[i * 4 + 3] = Texture->Pixels[i * 2 + 1];
+	}
+
+	free_texture_data(Texture);
+
+	Texture->Pixels = Pixels;
+	Texture->Channels = 4;
+
+	return 1;
+}
+
+static void write_level(const unsigned char* Pixels, int Width, int Height, int Channels, uint32_t Format, unsigned char* Out)
+{
+	if (is_format_compressed(Format))
+		compress_level(Pixels, Width, Height, Channels, Format, Out);
+	else
+		memcpy(Out, Pixels, (size_t)Width * Height * Channels);
+}
+
+bool build_texture_bake(TextureData_t* Source, bool Compress, const MipOptions_t* Options, TextureBake_t* Bake)
+{
+	Bake->Data = NULL;
+	Bake->Size = 0;
+	Bake->Owned = 1;
+
+	if (Source->Channels == 2 && !expand_grey_alpha(Source))
+		return 0;
+
+	TextureBakeHeader_t Header;
+	memset(&Header, 0, sizeof(Header));
+
+	Header.Magic = TEXTURE_BAKE_MAGIC;
+	Header.Version = TEXTURE_BAKE_VERSION;
+	Header.Format = pick_format(Source->Channels, Compress);
+
+	// Lay the levels out first so everything fits in one allocation
+	uint32_t Width = (uint32_t)Source->Width;
+	uint32_t Height = (uint32_t)Source->Height;
+	uint64_t Offset = sizeof(Header);
+
+	while (Header.LevelCount < TEXTURE_BAKE_MAX_LEVELS)
+	{
+		TextureBakeLevel_t* Level = &Header.Levels[Header.LevelCount++];
+
+		Level->Width = Width;
+		Level->Height = Height;
+		Level->Offset = Offset;
+		Level->Size = get_texture_bake_level_size(Header.Format, Width, Height);
+
+		Offset += Level->Size;
+
+		if (Width == 1 && Height == 1)
+			break;
+
+		Width = Width > 1 ? Width / 2 : 1;
+		Height = Height > 1 ? Height / 2 : 1;
+	}
+
+	unsigned char* Data = malloc(Offset);
+	unsigned char* Pixels = Header.LevelCount > 1 ? malloc((size_t)Header.Levels[1].Width * Header.Levels[1].Height * Source->Channels) : NULL;
+	MipChain_t Chain;
+
+	if (!Data || (Header.LevelCount > 1 && !Pixels) || !begin_mip_chain(&Chain, Source->Pixels, Source->Width, Source->Height, Source->Channels, Options))
+	{
+		free(Data);
+		free(Pixels);
+
+		return 0;
+	}
+
+	memcpy(Data, &Header, sizeof(Header));
+
+	// Level 0 goes in as decoded, the chain only has to produce the smaller ones
+	write_level(Source->Pixels, Source->Width, Source->Height, Source->Channels, Header.Format, Data + Header.Levels[0].Offset);
+
+	for (uint32_t i = 1; i < Header.LevelCount && next_mip_level(&Chain); ++i)
+	{
+		const TextureBakeLevel_t* Level = &Header.Levels[i];
+
+		read_mip_level(&Chain, Pixels);
+		write_level(Pixels, Level->Width, Level->Height, Source->Channels, Header.Format, Data + Level->Offset);
+	}
+
+	end_mip_chain(&Chain);
+	free(Pixels);
+
+	Bake->Data = Data;
+	Bake->Size = Offset;
+
+	return 1;
+}
+
+static bool write_texture_bake(const char* BakePath, const TextureBake_t* Bake)
+{
+	FILE* File = fopen(BakePath, "wb");
+
+	if (!File)
+		return 0;
+
+	bool Written = fwrite(Bake->Data, 1, Bake->Size, File) == Bake->Size;
+
+	if (fclose(File) != 0)
+		Written = 0;
+
+	if (!Written)
+		remove(BakePath);
+
+	return Written;
+}
+
+bool bake_texture(const char* Path, bool Compress, const MipOptions_t* Options)
+{
+	TextureData_t Source;
+
+	if (!load_texture_data(Path, &Source))
+		return 0;
+
+	TextureBake_t Bake;
+
+	if (!build_texture_bake(&Source, Compress, Options, &Bake))
+	{
+		printf("Failed to allocate for texture bake of '%s'\n", Path);
+		free_texture_data(&Source);
+
+		return 0;
+	}
+
+	char* BakePath = get_bake_path(Path);
+	bool Written = BakePath && write_texture_bake(BakePath, &Bake);
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Bake.Data;
+
+	if (Written)
+		printf("Baked texture '%s' - %dx%d Levels: %u Format: %s Size: %zu\n", Path, Source.Width, Source.Height, Header->LevelCount, FormatNames[Header->Format], Bake.Size);
+	else
+		printf("Failed to write texture bake for '%s'\n", Path);
+
+	free_texture_bake(&Bake);
+	free_texture_data(&Source);
+	free(BakePath);
+
+	return Written;
+}
+
+static bool map_texture_bake(const char* BakePath, const char* Name, bool AllowS3TC, TextureBake_t* Bake)
+{
+	void* Data;
+	size_t Size;
+
+	if (!map_file(BakePath, &Data, &Size))
+		return 0;
+
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Data;
+	bool Valid = Size >= sizeof(TextureBakeHeader_t)
+		&& Header->Magic == TEXTURE_BAKE_MAGIC
+		&& Header->Version == TEXTURE_BAKE_VERSION
+		&& Header->Format < TEXTURE_BAKE_FORMAT_COUNT
+		&& Header->LevelCount >= 1
+		&& Header->LevelCount <= TEXTURE_BAKE_MAX_LEVELS;
+
+	for (uint32_t i = 0; Valid && i < Header->LevelCount; ++i)
+	{
+		const TextureBakeLevel_t* Level = &Header->Levels[i];
+
+		Valid = Level->Width > 0
+			&& Level->Height > 0
+			&& Level->Size == get_texture_bake_level_size(Header->Format, Level->Width, Level->Height)
+			&& Level->Offset <= Size
+			&& Level->Size <= Size - Level->Offset;
+	}
+
+	if (!Valid)
+	{
+		printf("Ignoring invalid texture bake for '%s'\n", Name);
+
+		unmap_file(Data, Size);
+
+		return 0;
+	}
+
+	// Falls back to the source, which still works everywhere
+	if (!AllowS3TC && (Header->Format == TEXTURE_BAKE_FORMAT_BC1 || Header->Format == TEXTURE_BAKE_FORMAT_BC3))
+	{
+		unmap_file(Data, Size);
+
+		return 0;
+	}
+
+	Bake->Data = Data;
+	Bake->Size = Size;
+	Bake->Owned = 0;
+
+	return 1;
+}
+
+bool load_texture_bake(const char* Path, bool AllowS3TC, TextureBake_t* Bake)
+{
+	Bake->Data = NULL;
+	Bake->Size = 0;
+	Bake->Owned = 0;
+
+	char* BakePath = get_bake_path(Path);
+
+	if (!BakePath)
+		return 0;
+
+	bool Loaded = !is_bake_stale(Path, BakePath) && map_texture_bake(BakePath, Path, AllowS3TC, Bake);
+
+	free(BakePath);
+
+	return Loaded;
+}
+
+bool get_texture_bake_key(const char* Path, bool Compress, const MipOptions_t* Options, uint64_t* Key)
+{
+	uint64_t Hash;
+
+	if (!hash_file(Path, &Hash))
+		return 0;
+
+	// Fields one by one, the struct has padding
+	uint32_t Settings[] = { TEXTURE_BAKE_VERSION, Compress, Options->Filter, Options->SRGB, Options->PreserveCoverage, 0 };
+	memcpy(&Settings[5], &Options->AlphaCutoff, sizeof(float));
+
+	*Key = hash_data(Settings, sizeof(Settings), Hash);
+
+	if (*Key == 0)
+		*Key = 1; // 0 marks bakes that aren't from the cache
+
+	return 1;
+}
+
+bool load_cached_texture_bake(uint64_t Key, TextureBake_t* Bake)
+{
+	Bake->Data = NULL;
+	Bake->Size = 0;
+	Bake->Owned = 0;
+
+	char* BakePath = get_cached_bake_path(Key);
+
+	if (!BakePath)
+		return 0;
+
+	bool Loaded = map_texture_bake(BakePath, BakePath, 1, Bake);
+
+	// Guards against a collision with a file that isn't from the cache
+	if (Loaded && ((const TextureBakeHeader_t*)Bake->Data)->Key != Key)
+	{
+		free_texture_bake(Bake);
+		Loaded = 0;
+	}
+
+	free(BakePath);
+
+	return Loaded;
+}
+
+void save_cached_texture_bake(uint64_t Key, TextureBake_t* Bake)
+{
+	if (!Bake->Owned)
+		return;
+
+	((TextureBakeHeader_t*)Bake->Data)->Key = Key;
+
+	char* BakePath = get_cached_bake_path(Key);
+	size_t Length = BakePath ? strlen(BakePath) : 0;
+	char* TempPath = BakePath ? malloc(Length + 32) : NULL;
+
+	if (!TempPath)
+	{
+		free(BakePath);
+		return;
+	}
+
+	// Written aside and renamed over so a crash or another instance never sees half a file
+	snprintf(TempPath, Length + 32, "%s.%p.tmp", BakePath, (void*)Bake);
+
+	if (!write_texture_bake(TempPath, Bake))
+		printf("Failed to write cached texture bake '%s'\n", BakePath);
+	else if (rename(TempPath, BakePath) != 0)
+	{
+		remove(BakePath); // Windows won't rename over an existing file
+
+		if (rename(TempPath, BakePath) != 0)
+			remove(TempPath);
+	}
+
+	free(TempPath);
+	free(BakePath);
+}
+
+unsigned int upload_texture_bake(const TextureBake_t* Bake, size_t* Size)
+{
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Bake->Data;
+
+	unsigned int ID;
+	glGenTextures(1, &ID);
+	glBindTexture(GL_TEXTURE_2D, ID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)Header->LevelCount - 1);
+
+	*Size = 0;
+
+	for (uint32_t i = 0; i < Header->LevelCount; ++i)
+		*Size += upload_texture_bake_level(Bake, i);
+
+	return ID;
+}
+
+size_t upload_texture_bake_level(const TextureBake_t* Bake, uint32_t Level)
+{
+	const unsigned char* Base = (const unsigned char*)Bake->Data;
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Base;
+	const TextureBakeLevel_t* Info = &Header->Levels[Level];
+
+	unsigned int InternalFormat, PixelFormat;
+	bool Compressed = get_texture_bake_gl_format(Header->Format, &InternalFormat, &PixelFormat);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // RGB8 rows aren't padded
+
+	if (Compressed)
+		glCompressedTexImage2D(GL_TEXTURE_2D, Level, InternalFormat, Info->Width, Info->Height, 0, (int)Info->Size, Base + Info->Offset);
+	else
+		glTexImage2D(GL_TEXTURE_2D, Level, InternalFormat, Info->Width, Info->Height, 0, PixelFormat, GL_UNSIGNED_BYTE, Base + Info->Offset);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return Info->Size;
+}
+
+void free_texture_bake(TextureBake_t* Bake)
+{
+	if (Bake->Owned)
+		free(Bake->Data);
+	else
+		unmap_file(Bake->Data, Bake->Size);
+
+	Bake->Data = NULL;
+	Bake->Size = 0;
+}
@@ -0,0 +1,68 @@
+#ifndef ogt_texture_bake
+#define ogt_texture_bake
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "util.h"
+#include "mipgen.h"
+
+#define TEXTURE_BAKE_MAGIC 0x5454474F // "OGTT"
+#define TEXTURE_BAKE_VERSION 3
+#define TEXTURE_BAKE_EXTENSION ".ogtt"
+#define TEXTURE_BAKE_MAX_LEVELS 16
+#define TEXTURE_BAKE_CACHE_DIRECTORY "texturecache" // Bakes made on the fly, named by cache key so moved or copied sources still hit
+
+typedef enum
+{
+	TEXTURE_BAKE_FORMAT_R8,
+	TEXTURE_BAKE_FORMAT_RGB8,
+	TEXTURE_BAKE_FORMAT_RGBA8,
+	TEXTURE_BAKE_FORMAT_BC1, // Needs GL_EXT_texture_compression_s3tc
+	TEXTURE_BAKE_FORMAT_BC3, // Same
+	TEXTURE_BAKE_FORMAT_BC4, // RGTC, core since 3.0
+
+	TEXTURE_BAKE_FORMAT_COUNT
+} TextureBakeFormat_t;
+
+typedef struct
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint64_t Offset;
+	uint64_t Size;
+} TextureBakeLevel_t;
+
+// Native byte order like the model cache, levels are stored largest first and already flipped for GL
+typedef struct
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t Format;
+	uint32_t LevelCount;
+	uint64_t Key; // Cache key it was saved under, 0 for bakes next to their source
+
+	TextureBakeLevel_t Levels[TEXTURE_BAKE_MAX_LEVELS];
+} TextureBakeHeader_t;
+
+typedef struct
+{
+	void* Data; // NULL when there's no usable bake
+	size_t Size;
+	bool Owned; // Built in memory rather than mapped from a file
+} TextureBake_t;
+
+size_t get_texture_bake_level_size(uint32_t Format, size_t Width, size_t Height);
+bool get_texture_bake_gl_format(uint32_t Format, unsigned int* InternalFormat, unsigned int* PixelFormat); // True for block compressed formats
+
+bool build_texture_bake(TextureData_t* Source, bool Compress, const MipOptions_t* Options, TextureBake_t* Bake); // Grey and alpha sources are expanded to RGBA in place
+bool bake_texture(const char* Path, bool Compress, const MipOptions_t* Options); // Writes Path.ogtt next to the source, nothing here needs GL
+bool load_texture_bake(const char* Path, bool AllowS3TC, TextureBake_t* Bake); // Safe to call off the main thread
+bool get_texture_bake_key(const char* Path, bool Compress, const MipOptions_t* Options, uint64_t* Key); // Hashes the source's contents along with the settings
+bool load_cached_texture_bake(uint64_t Key, TextureBake_t* Bake); // Safe to call off the main thread
+void save_cached_texture_bake(uint64_t Key, TextureBake_t* Bake); // Same, sets the bake's key
+unsigned int upload_texture_bake(const TextureBake_t* Bake, size_t* Size);
+size_t upload_texture_bake_level(const TextureBake_t* Bake, uint32_t Level); // Into the bound GL_TEXTURE_2D, returns its size
+void free_texture_bake(TextureBake_t* Bake);
+
+#endif
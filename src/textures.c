@@ -0,0 +1,701 @@
+#include "textures.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "globals.h"
+
+static bool has_gl_extension(const char* Name)
+{
+	int Count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &Count);
+
+	for (int i = 0; i < Count; ++i)
+	{
+		const char* Extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+
+		if (Extension && strcmp(Extension, Name) == 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+void ogt_init_texture_cache()
+{
+	GlobalVars->TextureCache = (TextureCache_t*)malloc(sizeof(TextureCache_t));
+
+	if (!GlobalVars->TextureCache)
+	{
+		printf("Failed to allocate for texture cache!\n");
+		return;
+	}
+
+	init_mutex(&GlobalVars->TextureCache->Lock);
+
+	GlobalVars->TextureCache->TextureMap = hashmap_create();
+	GlobalVars->TextureCache->S3TCSupported = has_gl_extension("GL_EXT_texture_compression_s3tc");
+	get_default_mip_options(&GlobalVars->TextureCache->MipOptions);
+	init_mip_tables();
+	GlobalVars->TextureCache->UseDiskCache = TEXTURE_DISK_CACHE && make_directory(TEXTURE_BAKE_CACHE_DIRECTORY);
+	GlobalVars->TextureCache->TextureCount = 0;
+	GlobalVars->TextureCache->Hits = 0;
+	GlobalVars->TextureCache->Misses = 0;
+	GlobalVars->TextureCache->DiskHits = 0;
+	GlobalVars->TextureCache->ResidentBytes = 0;
+
+	GlobalVars->TextureCache->UseArrays = TEXTURE_USE_ARRAYS;
+	GlobalVars->TextureCache->Arrays = NULL;
+	GlobalVars->TextureCache->ArrayCount = 0;
+	GlobalVars->TextureCache->ArrayCapacity = 0;
+	GlobalVars->TextureCache->UseStreaming = TEXTURE_STREAMING;
+	GlobalVars->TextureCache->Streamed = NULL;
+	GlobalVars->TextureCache->StreamedCount = 0;
+	GlobalVars->TextureCache->StreamedCapacity = 0;
+	GlobalVars->TextureCache->StreamedBytes = 0;
+	GlobalVars->TextureCache->StreamBudget = TEXTURE_STREAM_BUDGET;
+
+	GlobalVars->TextureCache->Bound2D = 0;
+	GlobalVars->TextureCache->BoundArray = 0;
+}
+
+Texture_t* ogt_acquire_texture(const char* Path, bool* Owner)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+	char* Normalized = normalize_path(Path);
+
+	*Owner = 0;
+
+	if (!Normalized)
+	{
+		printf("Failed to allocate for texture '%s'\n", Path);
+		return NULL;
+	}
+
+	size_t Length = strlen(Normalized);
+	uintptr_t Existing;
+
+	lock_mutex(&Cache->Lock);
+
+	if (hashmap_get(Cache->TextureMap, Normalized, Length, &Existing))
+	{
+		Texture_t* Texture = (Texture_t*)Existing;
+
+		Texture->RefCount++;
+		Cache->Hits++;
+
+		unlock_mutex(&Cache->Lock);
+
+		free(Normalized);
+
+		return Texture;
+	}
+
+	Texture_t* Texture = (Texture_t*)calloc(1, sizeof(Texture_t));
+
+	if (!Texture)
+	{
+		unlock_mutex(&Cache->Lock);
+
+		printf("Failed to allocate for texture '%s'\n", Path);
+		free(Normalized);
+
+		return NULL;
+	}
+
+	Texture->State = TEXTURE_STATE_LOADING;
+	Texture->Path = Normalized;
+	Texture->RefCount = 1;
+
+	hashmap_set(Cache->TextureMap, Texture->Path, Length, (uintptr_t)Texture);
+
+	Cache->TextureCount++;
+	Cache->Misses++;
+
+	unlock_mutex(&Cache->Lock);
+
+	*Owner = 1;
+
+	return Texture;
+}
+
+bool ogt_decode_texture(Texture_t* Texture)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	if (load_texture_bake(Texture->Path, Cache->S3TCSupported, &Texture->Bake))
+		return 1;
+
+	uint64_t Key;
+	bool Keyed = Cache->UseDiskCache && get_texture_bake_key(Texture->Path, 0, &Cache->MipOptions, &Key);
+
+	if (Keyed && load_cached_texture_bake(Key, &Texture->Bake))
+	{
+		lock_mutex(&Cache->Lock);
+		Cache->DiskHits++;
+		unlock_mutex(&Cache->Lock);
+
+		return 1;
+	}
+
+	if (!load_texture_data(Texture->Path, &Texture->Data))
+		return 0;
+
+	// Builds the same mip chain a bake would have so upload doesn't need glGenerateMipmap,
+	// out of memory just leaves the decoded pixels for the plain upload
+	if (build_texture_bake(&Texture->Data, 0, &Cache->MipOptions, &Texture->Bake))
+	{
+		free_texture_data(&Texture->Data);
+
+		if (Keyed)
+			save_cached_texture_bake(Key, &Texture->Bake);
+	}
+
+	return 1;
+}
+
+static void decode_texture_job(void* Data)
+{
+	ogt_decode_texture((Texture_t*)Data);
+}
+
+void ogt_decode_textures(Texture_t** Textures, size_t Count, JobCounter_t* Counter)
+{
+	for (size_t i = 0; i < Count; ++i)
+		ogt_submit_job(decode_texture_job, Textures[i], Counter);
+}
+
+static uint32_t get_full_level_count(uint32_t Width, uint32_t Height)
+{
+	uint32_t Size = Width > Height ? Width : Height;
+	uint32_t Levels = 1;
+
+	while (Size > 1)
+	{
+		Size /= 2;
+		Levels++;
+	}
+
+	return Levels;
+}
+
+static TextureArray_t* create_texture_array(uint32_t Width, uint32_t Height, uint32_t Format)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	if (Cache->ArrayCount >= Cache->ArrayCapacity)
+	{
+		size_t Capacity = Cache->ArrayCapacity > 0 ? Cache->ArrayCapacity * 2 : 8;
+		TextureArray_t** Arrays = realloc(Cache->Arrays, Capacity * sizeof(TextureArray_t*));
+
+		if (!Arrays)
+			return NULL;
+
+		Cache->Arrays = Arrays;
+		Cache->ArrayCapacity = Capacity;
+	}
+
+	TextureArray_t* Array = (TextureArray_t*)calloc(1, sizeof(TextureArray_t));
+
+	if (!Array)
+		return NULL;
+
+	Array->Width = Width;
+	Array->Height = Height;
+	Array->Format = Format;
+	Array->LevelCount = get_full_level_count(Width, Height);
+
+	unsigned int InternalFormat, PixelFormat;
+	bool Compressed = get_texture_bake_gl_format(Format, &InternalFormat, &PixelFormat);
+
+	glGenTextures(1, &Array->ID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, Array->ID);
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (int)Array->LevelCount - 1);
+
+	uint32_t LevelWidth = Width, LevelHeight = Height;
+
+	for (uint32_t i = 0; i < Array->LevelCount; ++i)
+	{
+		size_t LevelSize = get_texture_bake_level_size(Format, LevelWidth, LevelHeight) * TEXTURE_ARRAY_LAYERS;
+
+		if (Compressed)
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, i, InternalFormat, LevelWidth, LevelHeight, TEXTURE_ARRAY_LAYERS, 0, (int)LevelSize, NULL);
+		else
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, i, InternalFormat, LevelWidth, LevelHeight, TEXTURE_ARRAY_LAYERS, 0, PixelFormat, GL_UNSIGNED_BYTE, NULL);
+
+		Array->Size += LevelSize;
+
+		LevelWidth = LevelWidth > 1 ? LevelWidth / 2 : 1;
+		LevelHeight = LevelHeight > 1 ? LevelHeight / 2 : 1;
+	}
+
+	Cache->Arrays[Cache->ArrayCount++] = Array;
+	Cache->ResidentBytes += Array->Size;
+
+	return Array;
+}
+
+static void destroy_texture_array(TextureArray_t* Array)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	for (size_t i = 0; i < Cache->ArrayCount; ++i)
+	{
+		if (Cache->Arrays[i] == Array)
+		{
+			Cache->Arrays[i] = Cache->Arrays[--Cache->ArrayCount];
+			break;
+		}
+	}
+
+	if (Cache->BoundArray == Array->ID)
+		Cache->BoundArray = 0;
+
+	glDeleteTextures(1, &Array->ID);
+	Cache->ResidentBytes -= Array->Size;
+
+	free(Array);
+}
+
+// Finds a free layer in an array of the right shape, making a new array when they're all full
+static bool claim_texture_layer(Texture_t* Texture, uint32_t Width, uint32_t Height, uint32_t Format, uint32_t LevelCount)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	if (!Cache->UseArrays || Width > TEXTURE_ARRAY_MAX_SIZE || Height > TEXTURE_ARRAY_MAX_SIZE || LevelCount != get_full_level_count(Width, Height))
+		return 0;
+
+	TextureArray_t* Array = NULL;
+
+	for (size_t i = 0; !Array && i < Cache->ArrayCount; ++i)
+	{
+		TextureArray_t* Candidate = Cache->Arrays[i];
+
+		if (Candidate->Width == Width && Candidate->Height == Height && Candidate->Format == Format && Candidate->UsedCount < TEXTURE_ARRAY_LAYERS)
+			Array = Candidate;
+	}
+
+	if (!Array)
+		Array = create_texture_array(Width, Height, Format);
+
+	if (!Array)
+		return 0;
+
+	unsigned int Layer = 0;
+
+	while (Array->Used[Layer])
+		Layer++;
+
+	Array->Used[Layer] = 1;
+	Array->UsedCount++;
+
+	Texture->Array = Array;
+	Texture->Layer = Layer;
+	Texture->Size = Array->Size / TEXTURE_ARRAY_LAYERS;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, Array->ID);
+
+	return 1;
+}
+
+static void upload_bake_layers(Texture_t* Texture)
+{
+	const unsigned char* Base = (const unsigned char*)Texture->Bake.Data;
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Base;
+
+	unsigned int InternalFormat, PixelFormat;
+	bool Compressed = get_texture_bake_gl_format(Header->Format, &InternalFormat, &PixelFormat);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (uint32_t i = 0; i < Header->LevelCount; ++i)
+	{
+		const TextureBakeLevel_t* Level = &Header->Levels[i];
+
+		if (Compressed)
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, Texture->Layer, Level->Width, Level->Height, 1, InternalFormat, (int)Level->Size, Base + Level->Offset);
+		else
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, Texture->Layer, Level->Width, Level->Height, 1, PixelFormat, GL_UNSIGNED_BYTE, Base + Level->Offset);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+static uint32_t get_stream_start_level(const TextureBakeHeader_t* Header)
+{
+	uint32_t Level = 0;
+
+	while (Level + 1 < Header->LevelCount && (Header->Levels[Level].Width > TEXTURE_STREAM_START_SIZE || Header->Levels[Level].Height > TEXTURE_STREAM_START_SIZE))
+		Level++;
+
+	return Level;
+}
+
+// Uploads just the small mips and keeps the bake around for the rest
+static bool start_texture_stream(Texture_t* Texture)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Texture->Bake.Data;
+	uint32_t StartLevel = get_stream_start_level(Header);
+
+	if (!Cache->UseStreaming || StartLevel == 0)
+		return 0;
+
+	if (Cache->StreamedCount >= Cache->StreamedCapacity)
+	{
+		size_t Capacity = Cache->StreamedCapacity > 0 ? Cache->StreamedCapacity * 2 : 16;
+		Texture_t** Streamed = realloc(Cache->Streamed, Capacity * sizeof(Texture_t*));
+
+		if (!Streamed)
+			return 0;
+
+		Cache->Streamed = Streamed;
+		Cache->StreamedCapacity = Capacity;
+	}
+
+	glGenTextures(1, &Texture->ID);
+	glBindTexture(GL_TEXTURE_2D, Texture->ID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (int)StartLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)Header->LevelCount - 1);
+
+	Texture->Size = 0;
+
+	for (uint32_t i = StartLevel; i < Header->LevelCount; ++i)
+		Texture->Size += upload_texture_bake_level(&Texture->Bake, i);
+
+	Texture->Streamed = 1;
+	Texture->BaseLevel = StartLevel;
+	Texture->StartLevel = StartLevel;
+	Texture->RequestedSize = 0.f;
+
+	Cache->Streamed[Cache->StreamedCount++] = Texture;
+	Cache->StreamedBytes += Texture->Size;
+	Cache->ResidentBytes += Texture->Size;
+
+	return 1;
+}
+
+static void stop_texture_stream(Texture_t* Texture)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	for (size_t i = 0; i < Cache->StreamedCount; ++i)
+	{
+		if (Cache->Streamed[i] == Texture)
+		{
+			Cache->Streamed[i] = Cache->Streamed[--Cache->StreamedCount];
+			break;
+		}
+	}
+
+	Cache->StreamedBytes -= Texture->Size;
+}
+
+static uint32_t get_wanted_level(const Texture_t* Texture)
+{
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Texture->Bake.Data;
+	float Wanted = Texture->RequestedSize * TEXTURE_STREAM_TEXELS_PER_PIXEL;
+	uint32_t Level = Texture->StartLevel;
+
+	if (Wanted <= 0.f)
+		return Level; // Not drawn, no reason to load more
+
+	while (Level > 0 && Header->Levels[Level].Width < Wanted && Header->Levels[Level].Height < Wanted)
+		Level--;
+
+	return Level;
+}
+
+static void raise_texture_level(Texture_t* Texture)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	glBindTexture(GL_TEXTURE_2D, Texture->ID);
+
+	size_t Size = upload_texture_bake_level(&Texture->Bake, Texture->BaseLevel - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (int)--Texture->BaseLevel);
+
+	Texture->Size += Size;
+	Cache->StreamedBytes += Size;
+	Cache->ResidentBytes += Size;
+}
+
+static void drop_texture_level(Texture_t* Texture)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+	const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Texture->Bake.Data;
+
+	unsigned int InternalFormat, PixelFormat;
+	bool Compressed = get_texture_bake_gl_format(Header->Format, &InternalFormat, &PixelFormat);
+
+	glBindTexture(GL_TEXTURE_2D, Texture->ID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (int)Texture->BaseLevel + 1);
+
+	// Redefining the level as empty is the only way to hand its memory back without immutable storage
+	if (Compressed)
+		glCompressedTexImage2D(GL_TEXTURE_2D, Texture->BaseLevel, InternalFormat, 0, 0, 0, 0, NULL);
+	else
+		glTexImage2D(GL_TEXTURE_2D, Texture->BaseLevel, InternalFormat, 0, 0, 0, PixelFormat, GL_UNSIGNED_BYTE, NULL);
+
+	size_t Size = Header->Levels[Texture->BaseLevel++].Size;
+
+	Texture->Size -= Size;
+	Cache->StreamedBytes -= Size;
+	Cache->ResidentBytes -= Size;
+}
+
+// Mips nobody wants right now go first, then those drawn smallest, never from a texture drawn bigger than For
+static Texture_t* find_stream_victim(const Texture_t* For)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+	Texture_t* Victim = NULL;
+	bool VictimUnwanted = 0;
+
+	for (size_t i = 0; i < Cache->StreamedCount; ++i)
+	{
+		Texture_t* Texture = Cache->Streamed[i];
+
+		if (Texture == For || Texture->BaseLevel >= Texture->StartLevel)
+			continue;
+
+		bool Unwanted = Texture->BaseLevel < get_wanted_level(Texture);
+
+		if (!Unwanted && For && Texture->RequestedSize >= For->RequestedSize)
+			continue;
+
+		if (!Victim || (Unwanted && !VictimUnwanted) || (Unwanted == VictimUnwanted && Texture->RequestedSize < Victim->RequestedSize))
+		{
+			Victim = Texture;
+			VictimUnwanted = Unwanted;
+		}
+	}
+
+	return Victim;
+}
+
+void ogt_request_texture_size(Texture_t* Texture, float ScreenSize)
+{
+	if (Texture->Streamed && ScreenSize > Texture->RequestedSize)
+		Texture->RequestedSize = ScreenSize;
+}
+
+void ogt_set_texture_stream_budget(size_t Budget)
+{
+	GlobalVars->TextureCache->StreamBudget = Budget;
+}
+
+void ogt_stream_textures(double Budget)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+	double Deadline = glfwGetTime() + Budget;
+
+	if (Cache->StreamedCount == 0)
+		return;
+
+	Cache->Bound2D = 0;
+
+	// Only happens when the budget shrinks, the loop below never goes over
+	while (Cache->StreamedBytes > Cache->StreamBudget)
+	{
+		Texture_t* Victim = find_stream_victim(NULL);
+
+		if (!Victim)
+			break;
+
+		drop_texture_level(Victim);
+	}
+
+	do
+	{
+		Texture_t* Best = NULL;
+
+		for (size_t i = 0; i < Cache->StreamedCount; ++i)
+		{
+			Texture_t* Texture = Cache->Streamed[i];
+
+			if (Texture->BaseLevel > get_wanted_level(Texture) && (!Best || Texture->RequestedSize > Best->RequestedSize))
+				Best = Texture;
+		}
+
+		if (!Best)
+			break;
+
+		const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Best->Bake.Data;
+		size_t Cost = Header->Levels[Best->BaseLevel - 1].Size;
+
+		while (Cache->StreamedBytes + Cost > Cache->StreamBudget)
+		{
+			Texture_t* Victim = find_stream_victim(Best);
+
+			if (!Victim)
+				break;
+
+			drop_texture_level(Victim);
+		}
+
+		if (Cache->StreamedBytes + Cost > Cache->StreamBudget)
+			break; // Everything resident matters more
+
+		raise_texture_level(Best);
+	} while (glfwGetTime() < Deadline);
+
+	// Rendering fills these back in for the next update
+	for (size_t i = 0; i < Cache->StreamedCount; ++i)
+		Cache->Streamed[i]->RequestedSize = 0.f;
+}
+
+void ogt_upload_texture(Texture_t* Texture)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	// Whatever was bound on the active unit is about to change
+	Cache->Bound2D = 0;
+	Cache->BoundArray = 0;
+
+	if (Texture->Bake.Data)
+	{
+		const TextureBakeHeader_t* Header = (const TextureBakeHeader_t*)Texture->Bake.Data;
+
+		if (claim_texture_layer(Texture, Header->Levels[0].Width, Header->Levels[0].Height, Header->Format, Header->LevelCount))
+			upload_bake_layers(Texture);
+		else if (start_texture_stream(Texture))
+		{
+			Texture->State = TEXTURE_STATE_READY;
+			return; // Keeps the bake
+		}
+		else
+		{
+			Texture->ID = upload_texture_bake(&Texture->Bake, &Texture->Size);
+			Cache->ResidentBytes += Texture->Size;
+		}
+
+		Texture->State = TEXTURE_STATE_READY;
+
+		free_texture_bake(&Texture->Bake);
+
+		return;
+	}
+
+	if (!Texture->Data.Pixels)
+	{
+		Texture->State = TEXTURE_STATE_FAILED;
+		return;
+	}
+
+	Texture->ID = upload_texture(&Texture->Data, &Cache->MipOptions, &Texture->Size);
+
+	Cache->ResidentBytes += Texture->Size;
+
+	Texture->State = TEXTURE_STATE_READY;
+
+	free_texture_data(&Texture->Data);
+}
+
+void ogt_release_texture(Texture_t* Texture)
+{
+	if (!Texture)
+		return;
+
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	lock_mutex(&Cache->Lock);
+
+	if (--Texture->RefCount > 0)
+	{
+		unlock_mutex(&Cache->Lock);
+		return;
+	}
+
+	hashmap_remove(Cache->TextureMap, Texture->Path, strlen(Texture->Path));
+	Cache->TextureCount--;
+
+	unlock_mutex(&Cache->Lock);
+
+	if (Texture->Array)
+	{
+		Texture->Array->Used[Texture->Layer] = 0;
+
+		if (--Texture->Array->UsedCount == 0)
+			destroy_texture_array(Texture->Array);
+	}
+	else if (Texture->ID)
+	{
+		if (Texture->Streamed)
+			stop_texture_stream(Texture);
+
+		if (Cache->Bound2D == Texture->ID)
+			Cache->Bound2D = 0;
+
+		glDeleteTextures(1, &Texture->ID);
+		Cache->ResidentBytes -= Texture->Size;
+	}
+
+	free_texture_bake(&Texture->Bake);
+	free_texture_data(&Texture->Data);
+	free(Texture->Path);
+	free(Texture);
+}
+
+void ogt_bind_texture(const Texture_t* Texture)
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	if (Texture->Array)
+	{
+		if (Cache->BoundArray == Texture->Array->ID)
+			return;
+
+		glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_ARRAY);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, Texture->Array->ID);
+
+		Cache->BoundArray = Texture->Array->ID;
+	}
+	else
+	{
+		if (Cache->Bound2D == Texture->ID)
+			return;
+
+		glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_2D);
+		glBindTexture(GL_TEXTURE_2D, Texture->ID);
+
+		Cache->Bound2D = Texture->ID;
+	}
+}
+
+void ogt_reset_texture_binding()
+{
+	GlobalVars->TextureCache->Bound2D = 0;
+	GlobalVars->TextureCache->BoundArray = 0;
+}
+
+void ogt_print_texture_stats()
+{
+	TextureCache_t* Cache = GlobalVars->TextureCache;
+
+	lock_mutex(&Cache->Lock);
+
+	printf(
+		"Texture cache - Textures: %zu Resident: %zu bytes Hits: %zu Misses: %zu Disk hits: %zu\n",
+
+		Cache->TextureCount,
+		Cache->ResidentBytes,
+		Cache->Hits,
+		Cache->Misses,
+		Cache->DiskHits
+	);
+
+	unlock_mutex(&Cache->Lock);
+}
@@ -0,0 +1,109 @@
+#ifndef ogt_textures
+#define ogt_textures
+
+#include <stddef.h>
+#include <stdint.h>
+#include <hashmap/map.h>
+
+#include "threads.h"
+#include "jobs.h"
+#include "util.h"
+#include "texturebake.h"
+
+#define TEXTURE_USE_ARRAYS 1 // Same sized textures share GL_TEXTURE_2D_ARRAY layers so switching materials is a uniform, not a bind
+#define TEXTURE_ARRAY_LAYERS 8
+#define TEXTURE_ARRAY_MAX_SIZE 1024 // Bigger ones stay on their own, a mostly empty array of them wastes too much
+#define TEXTURE_STREAMING 1 // Textures too big for an array start at a small mip and load more as they're seen closer
+#define TEXTURE_STREAM_START_SIZE 64 // Largest side of the mip streamed textures start at, that and below always stay resident
+#define TEXTURE_STREAM_BUDGET ((size_t)256 * 1024 * 1024)
+#define TEXTURE_STREAM_UPLOAD_BUDGET 0.001 // Seconds per frame spent uploading mips
+#define TEXTURE_STREAM_TEXELS_PER_PIXEL 1.0f
+#define TEXTURE_DISK_CACHE 1 // Textures without a bake get one built and saved under TEXTURE_BAKE_CACHE_DIRECTORY for the next run
+#define TEXTURE_UNIT_2D 0
+#define TEXTURE_UNIT_ARRAY 1
+
+typedef enum
+{
+	TEXTURE_STATE_LOADING, // Decoding on a worker, or waiting for the load that owns it to upload it
+	TEXTURE_STATE_READY,
+	TEXTURE_STATE_FAILED
+} TextureState_t;
+
+typedef struct
+{
+	unsigned int ID;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Format; // TextureBakeFormat_t, decoded images use the uncompressed ones
+	uint32_t LevelCount;
+	size_t Size; // GPU bytes for every layer, used or not
+
+	bool Used[TEXTURE_ARRAY_LAYERS];
+	unsigned int UsedCount;
+} TextureArray_t;
+
+typedef struct
+{
+	TextureState_t State; // Main thread only
+	char* Path; // Normalized, also the map key
+	unsigned int ID; // Standalone texture, 0 when it lives in an array
+	TextureArray_t* Array;
+	unsigned int Layer;
+	unsigned int RefCount; // Guarded by the cache lock
+	size_t Size; // GPU bytes once uploaded, mips included
+
+	// Streamed textures keep their bake and only hold BaseLevel and below on the GPU
+	bool Streamed;
+	uint32_t BaseLevel;
+	uint32_t StartLevel;
+	float RequestedSize; // Largest it was drawn on screen in pixels since the last stream update
+
+	TextureBake_t Bake; // Baked mip chain, used instead of decoding when there is one
+	TextureData_t Data; // Decoded pixels, only the owner touches these
+} Texture_t;
+
+typedef struct
+{
+	Mutex_t Lock; // Workers look textures up while loading models
+	hashmap* TextureMap;
+	bool S3TCSupported; // Set once at init, BC1/BC3 bakes fall back to their source without it
+	MipOptions_t MipOptions; // For textures without a bake
+	bool UseDiskCache; // Set once at init, off when the directory can't be made
+
+	size_t TextureCount;
+	size_t Hits;
+	size_t Misses;
+	size_t DiskHits; // Misses served from the disk cache instead of decoding
+	size_t ResidentBytes; // Main thread only
+
+	// Main thread only from here on
+	bool UseArrays;
+	TextureArray_t** Arrays;
+	size_t ArrayCount;
+	size_t ArrayCapacity;
+
+	bool UseStreaming;
+	Texture_t** Streamed;
+	size_t StreamedCount;
+	size_t StreamedCapacity;
+	size_t StreamedBytes;
+	size_t StreamBudget;
+
+	unsigned int Bound2D;
+	unsigned int BoundArray;
+} TextureCache_t;
+
+void ogt_init_texture_cache();
+Texture_t* ogt_acquire_texture(const char* Path, bool* Owner); // Adds a reference, Owner is set when the caller has to decode and upload it
+bool ogt_decode_texture(Texture_t* Texture); // Owner only, safe off the main thread
+void ogt_decode_textures(Texture_t** Textures, size_t Count, JobCounter_t* Counter); // One job each, wait on Counter before uploading
+void ogt_upload_texture(Texture_t* Texture); // Owner only, main thread
+void ogt_release_texture(Texture_t* Texture); // Main thread only
+void ogt_request_texture_size(Texture_t* Texture, float ScreenSize); // Pixels across the surface using it, raises streamed residency
+void ogt_set_texture_stream_budget(size_t Budget);
+void ogt_stream_textures(double Budget); // Once a frame before rendering, uploads wanted mips and drops unwanted ones past the budget
+void ogt_bind_texture(const Texture_t* Texture); // Skips the bind when it's already there
+void ogt_reset_texture_binding(); // Call after binding textures outside of ogt_bind_texture
+void ogt_print_texture_stats();
+
+#endif
@@ -0,0 +1,154 @@
+#include "threads.h"
+
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+typedef struct
+{
+	ThreadFn Function;
+	void* Data;
+} ThreadStart_t;
+
+#ifdef _WIN32
+static DWORD WINAPI thread_start(LPVOID Param)
+#else
+static void* thread_start(void* Param)
+#endif
+{
+	ThreadStart_t Start = *(ThreadStart_t*)Param;
+	free(Param);
+
+	Start.Function(Start.Data);
+
+	return 0;
+}
+
+bool create_thread(Thread_t* Thread, ThreadFn Function, void* Data)
+{
+	ThreadStart_t* Start = malloc(sizeof(ThreadStart_t));
+
+	if (!Start)
+		return 0;
+
+	Start->Function = Function;
+	Start->Data = Data;
+
+#ifdef _WIN32
+	*Thread = CreateThread(NULL, 0, thread_start, Start, 0, NULL);
+
+	if (!*Thread)
+#else
+	if (pthread_create(Thread, NULL, thread_start, Start) != 0)
+#endif
+	{
+		free(Start);
+
+		return 0;
+	}
+
+	return 1;
+}
+
+void join_thread(Thread_t Thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(Thread, INFINITE);
+	CloseHandle(Thread);
+#else
+	pthread_join(Thread, NULL);
+#endif
+}
+
+unsigned int get_cpu_count()
+{
+#ifdef _WIN32
+	SYSTEM_INFO Info;
+	GetSystemInfo(&Info);
+
+	return Info.dwNumberOfProcessors > 0 ? (unsigned int)Info.dwNumberOfProcessors : 1;
+#else
+	long Count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return Count > 0 ? (unsigned int)Count : 1;
+#endif
+}
+
+void init_mutex(Mutex_t* Mutex)
+{
+#ifdef _WIN32
+	InitializeSRWLock(Mutex);
+#else
+	pthread_mutex_init(Mutex, NULL);
+#endif
+}
+
+void destroy_mutex(Mutex_t* Mutex)
+{
+#ifndef _WIN32
+	pthread_mutex_destroy(Mutex);
+#endif
+}
+
+void lock_mutex(Mutex_t* Mutex)
+{
+#ifdef _WIN32
+	AcquireSRWLockExclusive(Mutex);
+#else
+	pthread_mutex_lock(Mutex);
+#endif
+}
+
+void unlock_mutex(Mutex_t* Mutex)
+{
+#ifdef _WIN32
+	ReleaseSRWLockExclusive(Mutex);
+#else
+	pthread_mutex_unlock(Mutex);
+#endif
+}
+
+void init_condition(Condition_t* Condition)
+{
+#ifdef _WIN32
+	InitializeConditionVariable(Condition);
+#else
+	pthread_cond_init(Condition, NULL);
+#endif
+}
+
+void destroy_condition(Condition_t* Condition)
+{
+#ifndef _WIN32
+	pthread_cond_destroy(Condition);
+#endif
+}
+
+void wait_condition(Condition_t* Condition, Mutex_t* Mutex)
+{
+#ifdef _WIN32
+	SleepConditionVariableSRW(Condition, Mutex, INFINITE, 0);
+#else
+	pthread_cond_wait(Condition, Mutex);
+#endif
+}
+
+void signal_condition(Condition_t* Condition)
+{
+#ifdef _WIN32
+	WakeConditionVariable(Condition);
+#else
+	pthread_cond_signal(Condition);
+#endif
+}
+
+void broadcast_condition(Condition_t* Condition)
+{
+#ifdef _WIN32
+	WakeAllConditionVariable(Condition);
+#else
+	pthread_cond_broadcast(Condition);
+#endif
+}
@@ -0,0 +1,36 @@
+#ifndef ogt_threads
+#define ogt_threads
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef HANDLE Thread_t;
+typedef SRWLOCK Mutex_t;
+typedef CONDITION_VARIABLE Condition_t;
+#else
+#include <pthread.h>
+
+typedef pthread_t Thread_t;
+typedef pthread_mutex_t Mutex_t;
+typedef pthread_cond_t Condition_t;
+#endif
+
+typedef void (*ThreadFn)(void* Data);
+
+bool create_thread(Thread_t* Thread, ThreadFn Function, void* Data);
+void join_thread(Thread_t Thread);
+unsigned int get_cpu_count();
+
+void init_mutex(Mutex_t* Mutex);
+void destroy_mutex(Mutex_t* Mutex);
+void lock_mutex(Mutex_t* Mutex);
+void unlock_mutex(Mutex_t* Mutex);
+
+void init_condition(Condition_t* Condition);
+void destroy_condition(Condition_t* Condition);
+void wait_condition(Condition_t* Condition, Mutex_t* Mutex);
+void signal_condition(Condition_t* Condition);
+void broadcast_condition(Condition_t* Condition);
+
+#endif
@@ -2,6 +2,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <sys/stat.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <cglm/cglm.h>
@@ -11,6 +15,17 @@
 
 #include "globals.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <direct.h>
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 void read_file(const char* Path, char** Data, size_t* Length)
 {
 	*Data = NULL;
@@ -58,6 +73,246 @@ void read_file(const char* Path, char** Data, size_t* Length)
 	*Length = Size;
 }
 
+bool map_file(const char* Path, void** Data, size_t* Length)
+{
+	*Data = NULL;
+	*Length = 0;
+
+#ifdef _WIN32
+	HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (File == INVALID_HANDLE_VALUE)
+		return 0;
+
+	LARGE_INTEGER Size;
+
+	if (!GetFileSizeEx(File, &Size) || Size.QuadPart <= 0)
+	{
+		CloseHandle(File);
+
+		return 0;
+	}
+
+	HANDLE Mapping = CreateFileMappingA(File, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(File);
+
+	if (!Mapping)
+		return 0;
+
+	void* View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(Mapping); // The view keeps the mapping alive
+
+	if (!View)
+		return 0;
+
+	*Data = View;
+	*Length = (size_t)Size.QuadPart;
+#else
+	int File = open(Path, O_RDONLY);
+
+	if (File < 0)
+		return 0;
+
+	struct stat Info;
+
+	if (fstat(File, &Info) != 0 || Info.st_size <= 0)
+	{
+		close(File);
+
+		return 0;
+	}
+
+	void* View = mmap(NULL, (size_t)Info.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+	close(File);
+
+	if (View == MAP_FAILED)
+		return 0;
+
+	*Data = View;
+	*Length = (size_t)Info.st_size;
+#endif
+
+	return 1;
+}
+
+void unmap_file(void* Data, size_t Length)
+{
+	if (!Data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(Data);
+#else
+	munmap(Data, Length);
+#endif
+}
+
+bool get_file_time(const char* Path, time_t* Time)
+{
+	struct stat Info;
+
+	if (stat(Path, &Info) != 0)
+		return 0;
+
+	*Time = Info.st_mtime;
+
+	return 1;
+}
+
+bool make_directory(const char* Path)
+{
+#ifdef _WIN32
+	int Result = _mkdir(Path);
+#else
+	int Result = mkdir(Path, 0755);
+#endif
+
+	return Result == 0 || errno == EEXIST;
+}
+
+void* alloc_aligned(size_t Alignment, size_t Size)
+{
+#ifdef _WIN32
+	return _aligned_malloc(Size, Alignment);
+#else
+	return aligned_alloc(Alignment, Size);
+#endif
+}
+
+void free_aligned(void* Data)
+{
+#ifdef _WIN32
+	_aligned_free(Data);
+#else
+	free(Data);
+#endif
+}
+
+uint64_t hash_data(const void* Data, size_t Length, uint64_t Seed)
+{
+	// MurmurHash64A, a word at a time so hashing a source file costs next to nothing next to decoding it
+	const uint64_t Multiplier = 0xC6A4A7935BD1E995ull;
+	const unsigned char* Bytes = (const unsigned char*)Data;
+	uint64_t Hash = Seed ^ (Length * Multiplier);
+	size_t WordCount = Length / 8;
+
+	for (size_t i = 0; i < WordCount; ++i)
+	{
+		uint64_t Word;
+		memcpy(&Word, Bytes + i * 8, 8);
+
+		Word *= Multiplier;
+		Word ^= Word >> 47;
+		Word *= Multiplier;
+
+		Hash ^= Word;
+		Hash *= Multiplier;
+	}
+
+	size_t TailLength = Length & 7;
+
+	if (TailLength)
+	{
+		uint64_t Tail = 0;
+		memcpy(&Tail, Bytes + WordCount * 8, TailLength);
+
+		Hash ^= Tail;
+		Hash *= Multiplier;
+	}
+
+	Hash ^= Hash >> 47;
+	Hash *= Multiplier;
+	Hash ^= Hash >> 47;
+
+	return Hash;
+}
+
+bool hash_file(const char* Path, uint64_t* Hash)
+{
+	void* Data;
+	size_t Length;
+
+	if (!map_file(Path, &Data, &Length))
+		return 0;
+
+	*Hash = hash_data(Data, Length, 0);
+	unmap_file(Data, Length);
+
+	return 1;
+}
+
+char* normalize_path(const char* Path)
+{
+	char* Out = malloc(strlen(Path) + 2); // Room for "." when everything cancels out
+
+	if (!Out)
+		return NULL;
+
+	bool Absolute = Path[0] == '/' || Path[0] == '\\';
+	size_t Length = 0;
+
+	if (Absolute)
+		Out[Length++] = '/';
+
+	size_t Keep = Length; // The root and leading .. segments can't be collapsed
+	const char* Cursor = Path;
+
+	while (*Cursor)
+	{
+		while (*Cursor == '/' || *Cursor == '\\')
+			Cursor++;
+
+		const char* Segment = Cursor;
+
+		while (*Cursor && *Cursor != '/' && *Cursor != '\\')
+			Cursor++;
+
+		size_t SegmentLength = Cursor - Segment;
+
+		if (SegmentLength == 0 || (SegmentLength == 1 && Segment[0] == '.'))
+			continue;
+
+		bool Parent = SegmentLength == 2 && Segment[0] == '.' && Segment[1] == '.';
+
+		if (Parent && Length > Keep)
+		{
+			// Drop the last segment and the slash before it
+			while (Length > Keep && Out[Length - 1] != '/')
+				Length--;
+
+			if (Length > Keep)
+				Length--;
+
+			continue;
+		}
+
+		if (Parent && Absolute)
+			continue;
+
+		if (Length > 0 && Out[Length - 1] != '/')
+			Out[Length++] = '/';
+
+		memcpy(&Out[Length], Segment, SegmentLength);
+		Length += SegmentLength;
+
+		if (Parent)
+			Keep = Length;
+	}
+
+	if (Length == 0)
+		Out[Length++] = '.';
+
+	Out[Length] = '\0';
+
+#ifdef _WIN32
+	// Windows paths aren't case sensitive
+	for (size_t i = 0; i < Length; ++i)
+		Out[i] = (char)tolower((unsigned char)Out[i]);
+#endif
+
+	return Out;
+}
+
 char* load_shader_code(const char* Path)
 {
 	char* Code;
@@ -98,51 +353,141 @@ void attach_shader(Shader_t* Shader, unsigned int ShaderProgram)
 	delete_shader(Shader);
 }
 
-unsigned int create_texture(const char* Path)
+bool load_texture_data(const char* Path, TextureData_t* Texture)
 {
-	unsigned int Texture;
-	glGenTextures(1, &Texture);
-	glBindTexture(GL_TEXTURE_2D, Texture);
+	stbi_set_flip_vertically_on_load_thread(1);
+
+	Texture->Pixels = stbi_load(Path, &Texture->Width, &Texture->Height, &Texture->Channels, 0);
+
+	if (!Texture->Pixels)
+	{
+		printf("Failed to load texture at '%s'\n", Path);
+
+		return 0;
+	}
+
+	return 1;
+}
+
+void free_texture_data(TextureData_t* Texture)
+{
+	stbi_image_free(Texture->Pixels);
+
+	Texture->Pixels = NULL;
+}
+
+unsigned int upload_texture(const TextureData_t* Texture, const MipOptions_t* Options, size_t* Size)
+{
+	unsigned int ID;
+	glGenTextures(1, &ID);
+	glBindTexture(GL_TEXTURE_2D, ID);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-	stbi_set_flip_vertically_on_load(1);
+	*Size = 0;
+
+	if (!Texture->Pixels)
+		return ID;
 
-	int Width, Height, Channels;
-	unsigned char* Data = stbi_load(Path, &Width, &Height, &Channels, 0);
+	unsigned int Format;
 
-	if (Data)
+	switch (Texture->Channels)
 	{
-		unsigned int Format;
+		case 1:
+			Format = GL_RED;
+			break;
+
+		default:
+		case 3:
+			Format = GL_RGB;
+			break;
+
+		case 4:
+			Format = GL_RGBA;
+			break;
+	}
 
-		switch (Channels)
-		{
-			case 1:
-				Format = GL_RED;
-				break;
-
-			default:
-			case 3:
-				Format = GL_RGB;
-				break;
-
-			case 4:
-				Format = GL_RGBA;
-				break;
-		}
+	int Width = Texture->Width;
+	int Height = Texture->Height;
+	int Level = 0;
+	MipChain_t Chain;
+
+	// Room for level 1, every level after it is smaller
+	unsigned char* Pixels = malloc((size_t)(Width > 1 ? Width / 2 : 1) * (Height > 1 ? Height / 2 : 1) * Texture->Channels);
+	bool Chained = Pixels && begin_mip_chain(&Chain, Texture->Pixels, Width, Height, Texture->Channels, Options);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // RGB8 rows aren't padded
+	glTexImage2D(GL_TEXTURE_2D, 0, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, Texture->Pixels);
+
+	*Size += (size_t)Width * Height * Texture->Channels;
+
+	while (Chained && (Width > 1 || Height > 1) && next_mip_level(&Chain))
+	{
+		Width = Width > 1 ? Width / 2 : 1;
+		Height = Height > 1 ? Height / 2 : 1;
+
+		read_mip_level(&Chain, Pixels);
+		glTexImage2D(GL_TEXTURE_2D, ++Level, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, Pixels);
 
-		glTexImage2D(GL_TEXTURE_2D, 0, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, Data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		*Size += (size_t)Width * Height * Texture->Channels;
 	}
-	else
-		printf("Failed to load texture at '%s'\n", Path);
 
-	stbi_image_free(Data);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, Level); // Short chains still sample as complete
+
+	if (Chained)
+		end_mip_chain(&Chain);
+
+	free(Pixels);
+
+	return ID;
+}
+
+unsigned short float_to_half(float Value)
+{
+	union
+	{
+		float Float;
+		uint32_t Bits;
+	} In = { Value };
+
+	uint32_t Sign = (In.Bits >> 16) & 0x8000;
+	int32_t Exponent = (int32_t)((In.Bits >> 23) & 0xFF);
+	uint32_t Mantissa = In.Bits & 0x7FFFFF;
+
+	if (Exponent == 0xFF) // inf/nan
+		return (unsigned short)(Sign | 0x7C00 | (Mantissa ? 0x200 : 0));
+
+	Exponent += 15 - 127;
+
+	if (Exponent >= 31)
+		return (unsigned short)(Sign | 0x7C00);
+
+	if (Exponent <= 0) // Denormal or zero
+	{
+		if (Exponent < -10)
+			return (unsigned short)Sign;
+
+		Mantissa |= 0x800000;
+
+		uint32_t Shift = (uint32_t)(14 - Exponent);
+		uint32_t Half = Mantissa >> Shift;
+
+		if ((Mantissa >> (Shift - 1)) & 1)
+			Half++;
+
+		return (unsigned short)(Sign | Half);
+	}
+
+	uint32_t Half = Sign | ((uint32_t)Exponent << 10) | (Mantissa >> 13);
+
+	if (Mantissa & 0x1000) // Round, a carry into the exponent is still correct
+		Half++;
 
-	return Texture;
+	return (unsigned short)Half;
 }
 
 void normalize_angle(float* Angle)
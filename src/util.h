@@ -2,9 +2,22 @@
 #define ogt_util
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
 #include <cglm/types.h>
 
+#include "mipgen.h"
+
 void read_file(const char* Path, char** Data, size_t* Length);
+bool map_file(const char* Path, void** Data, size_t* Length);
+void unmap_file(void* Data, size_t Length);
+bool get_file_time(const char* Path, time_t* Time);
+bool make_directory(const char* Path); // Also true when it's already there
+void* alloc_aligned(size_t Alignment, size_t Size); // Size must be a multiple of Alignment
+void free_aligned(void* Data);
+uint64_t hash_data(const void* Data, size_t Length, uint64_t Seed); // Fast, not for anything security related
+bool hash_file(const char* Path, uint64_t* Hash);
+char* normalize_path(const char* Path); // Resolves . and .. and unifies slashes so equal files compare equal, free the result
 
 typedef struct
 {
@@ -18,7 +31,19 @@ bool load_shader(unsigned int Type, unsigned int Count, const char* Path, Shader
 void delete_shader(Shader_t* Shader);
 void attach_shader(Shader_t* Shader, unsigned int ShaderProgram);
 
-unsigned int create_texture(const char* Path);
+typedef struct
+{
+	unsigned char* Pixels;
+	int Width;
+	int Height;
+	int Channels;
+} TextureData_t;
+
+bool load_texture_data(const char* Path, TextureData_t* Texture); // Safe to call off the main thread
+void free_texture_data(TextureData_t* Texture);
+unsigned int upload_texture(const TextureData_t* Texture, const MipOptions_t* Options, size_t* Size); // Mips come from the CPU chain, only level 0 if that fails
+
+unsigned short float_to_half(float Value);
 
 void normalize_angle(float* Angle);
 void normalize_angles(vec3 Angles);